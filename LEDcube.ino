@@ -8,19 +8,64 @@
 #include "global.h"
 #include "button.h"
 #include "effects.h"
+#include "draw.h"
+#include "protocol.h"
+#include "uart.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "text.h"
+#include "upload.h"
 
 #define BAUD_RATE 115200         // 57600 bps 115200 bps
 
-// cube state buffer
+// cube state buffers (See draw.cpp)
 #ifdef ARDUINO_X4
-uint8_t cube[4][2];              // LAYER2__LAYER1
-uint8_t tmpCube[4][2];
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][4][2];   // LAYER2__LAYER1
+extern uint8_t (*cube)[2];                                      // back buffer
 #elif ARDUINO_X8
-uint8_t cube[8][8];              // [z][y][x]
-uint8_t tmpCube[8][8];
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][8][8];   // [z][y][x]
+extern uint8_t (*cube)[8];                                      // back buffer
 #else
 #error "Please specify cube size in Arduino configuration"
 #endif
+extern bool grayBuffer[CUBE_BUFFER_COUNT];
+extern volatile uint8_t displayLevel;
+
+// Bit-angle modulation time unit in Timer1 ticks (prescaler 8 -> 1843200 ticks/s).
+// Every layer is shown for MAX_LEVEL units, plane p for 2^(BAM_BITS-1-p) units:
+// ARDUINO_X4: 4 layers * 15 * 26 ticks, ARDUINO_X8: 8 layers * 15 * 13 ticks
+// -> LED update frequency = 1181 Hz
+// The ISR runs once per bitplane of every layer, BAM_BITS * LAYER_COUNT times per refresh:
+// ARDUINO_X4 18.9k, ARDUINO_X8 37.8k interrupts/s. The shortest slot (BAM_UNIT ticks,
+// 104 CPU cycles on ARDUINO_X8) can end before a late ISR has set it (See the ISR).
+#ifdef ARDUINO_X4
+#define BAM_UNIT 26
+#else
+#define BAM_UNIT 13
+#endif
+#define REFRESH_TICKS (BAM_UNIT * MAX_LEVEL * LAYER_COUNT)
+
+// Data the ISR shifts out per layer (See OUTPUT_BACKEND in draw.h)
+#ifdef RENDER_OUTPUT
+extern uint8_t outputBuffer[CUBE_BUFFER_COUNT][BAM_BITS][4][OUTPUT_SIZE];
+#define SCAN_BUFFER outputBuffer
+#define SCAN_SIZE OUTPUT_SIZE
+#else
+#define SCAN_BUFFER cubeBuffer
+#define SCAN_SIZE LAYER_SIZE
+#endif
+
+#if OUTPUT_BACKEND == OUTPUT_UNROLLED
+// One shift register clock: the data is stable for one cycle (68 ns) before the
+// rising edge and the clock is high for two cycles, the 74HC595 needs 25 ns and 20 ns.
+#ifdef ARDUINO_X4
+#define SHIFT_OUT(data) do { PORTD = (data); PORTC |= (1<<PC0); PORTC &= ~(1<<PC0); } while (0)
+#define LATCH_OUT()     do { PORTC |= (1<<PC1); PORTC &= ~(1<<PC1); } while (0)
+#elif ARDUINO_X8
+#define SHIFT_OUT(data) do { PORTA = (data); PORTD |= (1<<PD6); PORTD &= ~(1<<PD6); } while (0)
+#define LATCH_OUT()     do { PORTD |= (1<<PD7); PORTD &= ~(1<<PD7); } while (0)
+#endif
+#endif
 
 // Buttons
 Button Button1;
@@ -28,24 +73,44 @@ Button Button1;
 Button Button2;
 #endif
 
-extern uint8_t brightness;
-uint8_t dimCounter;
-
-// Counts through the layers (starting from 0)
-uint8_t current_layer = LAYER_COUNT;
+// Counts through the layers and their bitplanes (starting from 0)
+uint8_t current_layer = LAYER_COUNT-1;
+uint8_t current_plane = BAM_BITS-1;
 
 // Current state (See global.h)
 uint8_t state = STATE_IDLE;
 int8_t requestedState = -1;
 
-struct SerialPacket {
-    char data[50];
-    int8_t length;
-} receivePacket;
-char lastReceivedByte;
+// Serial text protocol
+#define LINE_BUFFER_SIZE 16     // longest command line including "\r"
+
+// Parser states
+#define PARSE_LINE     0        // collecting a command line
+#define PARSE_DATA     1        // binary arguments of a command, they go straight to their buffer
+#define PARSE_DATA_END 2        // binary arguments: expecting "\r\n"
+#define PARSE_DISCARD  3        // invalid or too long line, skipping to the next "\r\n"
+#define PARSE_TEXT     4        // TEXT: the characters go straight into the text (See text.h)
+
+// Commands with binary arguments
+#define COMMAND_RAW    0        // "RAW<layer>" [layer data]
+#define COMMAND_UPLOAD 1        // "UPLOAD" [size] [crc] (See upload.h)
+#define COMMAND_BLOCK  2        // "BLOCK" [index] [data] [crc] (See upload.h)
 
-uint8_t rawPacketCount;
+struct SerialParser {
+    char line[LINE_BUFFER_SIZE+1];  // terminated before processing
+    uint8_t length;
+    uint8_t state;
+    uint8_t command;            // command receiving binary arguments
+    uint8_t *data;              // destination of the arguments (0: skip them)
+    uint8_t size;               // number of bytes in the arguments
+    uint8_t position;           // next byte of the arguments
+    char lastByte;
+} parser;
+uint16_t discardedBytes;
+
+uint8_t rawLayers;              // RAW: layers of the current frame received so far (bit z)
 bool serialConnected;
+bool binaryMode;                // binary protocol active (See protocol.h)
 bool effectShouldFinish;
 
 // Update state
@@ -55,43 +120,52 @@ void updateState(uint8_t value)
         effectShouldFinish = false;
         requestedState = -1;
         state = value;
+        if (state != STATE_SERIAL) {
+            binaryMode = false;
+            // the rest of a RAW layer would go into a back buffer the effects present
+            // meanwhile: skip it and drop the frame
+            if (parser.command == COMMAND_RAW) {
+                parser.data = 0;
+            }
+            rawLayers = 0;
+        }
         if (serialConnected) {
-            Serial.print("STATE ");
+            uartPrint("STATE ");
             if (state == STATE_SERIAL) {
-                Serial.println("SERIAL");
+                uartPrintln("SERIAL");
             } else if (state == STATE_EFFECTS) {
-                Serial.println("EFFECTS");
+                uartPrintln("EFFECTS");
             } else {
-                Serial.println("IDLE");
+                uartPrintln("IDLE");
             }
         }
     }
 }
 
-// Process received serial packet
+// Process a received command line (without "\r\n")
 void processSerialPacket()
 {
-    if (!strncmp(receivePacket.data, "HELLO", 5))               // Handshake
+    if (!strncmp(parser.line, "HELLO", 5))               // Handshake
     {
         serialConnected = true;
-        Serial.println("LEDcube v1.0");
+        uartPrintln("LEDcube v1.0");
         updateState(state);
     }
-    else if (!strncmp(receivePacket.data, "STATE ", 6))         // change state
+    else if (!strncmp(parser.line, "STATE ", 6))         // change state
     {
-        if (!strncmp(&receivePacket.data[6], "IDLE", 4)) {
+        if (!strncmp(&parser.line[6], "IDLE", 4)) {
             if (state == STATE_EFFECTS) {
                 effectShouldFinish = true;
                 requestedState = STATE_IDLE;
             } else {
                 updateState(STATE_IDLE);
             }
-        } else if (!strncmp(&receivePacket.data[6], "EFFECTS", 7)) {
+        } else if (!strncmp(&parser.line[6], "EFFECTS", 7)) {
             if (state != STATE_EFFECTS) {
                 updateState(STATE_EFFECTS);
                 startEffect(0);
             }
-        } else if (!strncmp(&receivePacket.data[6], "SERIAL", 6)) {
+        } else if (!strncmp(&parser.line[6], "SERIAL", 6)) {
             if (state == STATE_EFFECTS) {
                 effectShouldFinish = true;
                 requestedState = STATE_SERIAL;
@@ -100,59 +174,279 @@ void processSerialPacket()
             }
         }
     }
-    else if(!strncmp(receivePacket.data, "BRIGHTNESS ", 11) && state == STATE_SERIAL &&
-            receivePacket.length == 12 && receivePacket.data[11] < MAX_BRIGHTNESS)
+    else if (!strncmp(parser.line, "BINARY", 6) && state == STATE_SERIAL)    // binary protocol
     {
-        brightness = receivePacket.data[11];
+        uartPrintln("BINARY");
+        protocolReset();
+        binaryMode = true;
     }
-#ifdef ARDUINO_X4
-    else if (!strncmp(receivePacket.data, "RAW", 3) && state == STATE_SERIAL &&
-            receivePacket.length == 6 && receivePacket.data[3] < LAYER_COUNT)            // RAW data
+    else if (!strncmp(parser.line, "STATS", 5))          // load and error statistics
     {
-        tmpCube[receivePacket.data[3]][0] = receivePacket.data[4];
-        tmpCube[receivePacket.data[3]][1] = receivePacket.data[5];
-        ++rawPacketCount;
-        if (rawPacketCount == LAYER_COUNT) {
-            memcpy(cube, tmpCube, 8);
-            rawPacketCount = 0;
+        printStats();
+    }
+    else if(!strncmp(parser.line, "BRIGHTNESS ", 11) && state == STATE_SERIAL &&
+            parser.length == 12 && parser.line[11] < MAX_BRIGHTNESS)
+    {
+        setBrightness(parser.line[11]);
+    }
+}
+
+// A RAW layer has been received completely. A frame is only presented with all its
+// layers, a frame missing one is dropped.
+void rawLayerReceived(uint8_t layer)
+{
+    if (rawLayers & (1 << layer)) {
+        uartPrintln("NAK RAW");
+        rawLayers = 0;
+    }
+    rawLayers |= (1 << layer);
+    if (rawLayers == (uint8_t)((1 << LAYER_COUNT) - 1)) {
+        present(false);
+        rawLayers = 0;
+    }
+}
+
+// An UPLOAD command has been received completely
+void uploadReceived()
+{
+    uint16_t block = uploadStart();
+
+    if (block == UPLOAD_INVALID || block == UPLOAD_BUSY) {
+        uartPrintln("UPLOAD ERROR");
+    } else {
+        uartPrint("UPLOAD ");
+        uartPrintNumber(block);
+        uartPrintln("");
+    }
+}
+
+// Ask for the block expected next
+void printUploadNak()
+{
+    uartPrint("NAK ");
+    uartPrintNumber(uploadWrittenBlocks());
+    uartPrintln("");
+}
+
+// A BLOCK command has been received completely, or dropped while receiving it.
+// The ACK follows when the block is in the EEPROM (See processUpload()).
+void blockReceived(bool dropped)
+{
+    uint8_t result = dropped ? BLOCK_NAK : uploadBlock();
+
+    if (result == BLOCK_NAK) {
+        printUploadNak();
+    } else if (result == BLOCK_ACK) {
+        uartPrint("ACK ");
+        uartPrintNumber(uploadBuffer[0] | (uploadBuffer[1] << 8));
+        uartPrintln("");
+    }
+}
+
+// The binary arguments of a command have been received completely
+void dataReceived()
+{
+    if (parser.command == COMMAND_RAW) {
+        if (parser.data) {
+            rawLayerReceived(parser.line[3]);
+        }
+    } else if (parser.command == COMMAND_UPLOAD) {
+        if (parser.data) {
+            uploadReceived();
+        } else {
+            uartPrintln("UPLOAD ERROR");
         }
+    } else {
+        blockReceived(!parser.data);
+    }
+}
+
+// Report the progress of the upload
+void processUpload()
+{
+    uint8_t result = uploadPoll();
+
+    if (result == UPLOAD_ACK) {
+        uartPrint("ACK ");
+        uartPrintNumber(uploadWrittenBlocks() - 1);
+        uartPrintln("");
+    } else if (result == UPLOAD_DONE) {
+        uartPrintln("DONE");
+    } else if (result == UPLOAD_FAILED) {
+        uartPrintln("FAILED");
     }
-#else // ARDUINO_X8
-    else if (!strncmp(receivePacket.data, "RAW", 3) && state == STATE_SERIAL &&
-            receivePacket.length == LAYER_COUNT+4 && receivePacket.data[3] < LAYER_COUNT) // RAW data
+}
+
+// Receive the binary arguments of a command into the buffer (0: skip them)
+void receiveData(uint8_t command, uint8_t *data, uint8_t size)
+{
+    parser.command = command;
+    parser.data = data;
+    parser.size = size;
+    parser.position = 0;
+    parser.state = PARSE_DATA;
+}
+
+#if TEXT_SUPPORTED
+// A TEXT command has been received completely: show the text right away
+void textReceived()
+{
+    updateState(STATE_EFFECTS);
+    startEffect(EFFECT_text);
+}
+#endif
+
+// Go on with the next command line
+void resetParser()
+{
+    parser.state = PARSE_LINE;
+    parser.length = 0;
+}
+
+// Text protocol parser, consumes one byte at a time
+void parseSerialByte(char data)
+{
+    if (parser.state == PARSE_LINE)
     {
-        uint8_t i;
-        for(i = 0; i < LAYER_COUNT; ++i) {
-            tmpCube[receivePacket.data[3]][i] = receivePacket.data[4+i];
+        if (data == '\n' && parser.lastByte == '\r') {
+            parser.line[--parser.length] = '\0';
+            processSerialPacket();
+            resetParser();
+        } else if (parser.length == LINE_BUFFER_SIZE) {
+            discardedBytes += parser.length + 1;
+            parser.state = PARSE_DISCARD;
+        } else {
+            parser.line[parser.length++] = data;
+
+            // "RAW<layer>": the layer data is written directly into the back buffer
+            if (parser.length == 4 && !strncmp(parser.line, "RAW", 3)) {
+                if (state == STATE_SERIAL && (uint8_t)parser.line[3] < LAYER_COUNT) {
+                    receiveData(COMMAND_RAW, cube[(uint8_t)parser.line[3]], LAYER_SIZE);
+                } else {
+                    receiveData(COMMAND_RAW, 0, LAYER_SIZE);
+                }
+            }
+            // "UPLOAD" and "BLOCK": the animation upload (See upload.h)
+            // (the previous block may still be written from the buffer)
+            if (parser.length == 6 && !strncmp(parser.line, "UPLOAD", 6)) {
+                receiveData(COMMAND_UPLOAD, state == STATE_SERIAL && !uploadBusy() ? uploadBuffer : 0,
+                            UPLOAD_ARGUMENTS_SIZE);
+            }
+            if (parser.length == 5 && !strncmp(parser.line, "BLOCK", 5)) {
+                receiveData(COMMAND_BLOCK, state == STATE_SERIAL && !uploadBusy() ? uploadBuffer : 0,
+                            BLOCK_ARGUMENTS_SIZE);
+            }
+#if TEXT_SUPPORTED
+            // "TEXT <string>": the string may be longer than the line buffer
+            if (parser.length == 5 && !strncmp(parser.line, "TEXT ", 5)) {
+                textClear();
+                parser.state = PARSE_TEXT;
+            }
+#endif
         }
-        ++rawPacketCount;
-        if (rawPacketCount == LAYER_COUNT) {
-            memcpy(cube, tmpCube, 64);
-            rawPacketCount = 0;
+    }
+#if TEXT_SUPPORTED
+    else if (parser.state == PARSE_TEXT)
+    {
+        if (data == '\n' && parser.lastByte == '\r') {
+            textReceived();
+            resetParser();
+        } else if (data != '\r') {
+            textAppend(data);
         }
     }
 #endif
+    else if (parser.state == PARSE_DATA)
+    {
+        if (parser.data) {
+            parser.data[parser.position] = data;
+        }
+        if (++parser.position == parser.size) {
+            parser.state = PARSE_DATA_END;
+        }
+    }
+    else if (parser.state == PARSE_DATA_END)
+    {
+        if (data == '\n' && parser.lastByte == '\r' && parser.position == parser.size+1) {
+            dataReceived();
+            resetParser();
+        } else if (data == '\r' && parser.position == parser.size) {
+            ++parser.position;
+        } else {
+            discardedBytes += parser.length + parser.size;
+            parser.state = PARSE_DISCARD;
+        }
+    }
+    else // PARSE_DISCARD
+    {
+        if (data == '\n' && parser.lastByte == '\r') {
+            resetParser();
+        } else {
+            ++discardedBytes;
+        }
+    }
+    parser.lastByte = data;
+}
+
+// Send a reply packet of the binary protocol (See protocol.h)
+void sendProtocolReply(uint8_t type)
+{
+    uint8_t packet[REPLY_PACKET_SIZE];
+    uint8_t length = protocolReply(type, packet);
+
+    for (uint8_t i = 0; i < length; ++i) {
+        uartWrite(packet[i]);
+    }
+}
+
+// Present a frame waiting for the display or the next queued one. Returns false while
+// a frame still waits, the bytes received meanwhile stay in the UART buffer.
+bool pollProtocol()
+{
+    uint8_t result = protocolPoll();
+
+    if (result == PROTOCOL_CREDIT) {
+        sendProtocolReply(PACKET_ACK);
+    }
+    return result != PROTOCOL_WAIT;
 }
 
 // Handles serial communication with the computer
-void serialEvent()
+void processSerialInput()
 {
-    while (Serial.available()) {
-        char data = Serial.read();
-        if (lastReceivedByte == '\r' && data == '\n') {
-            --receivePacket.length;
-            processSerialPacket();
+    if (binaryMode && !pollProtocol()) {
+        return;
+    }
+    while (uartAvailable()) {
+        uint8_t data = uartRead();
+        PROFILE_SERIAL_BYTE();
+        if (binaryMode) {
+            uint8_t result = protocolReceive(data);
+            if (result == PROTOCOL_TEXT) {
+                binaryMode = false;
+                resetParser();
+                uartPrintln("TEXT");
+            } else if (result == PROTOCOL_FRAME || result == PROTOCOL_DUPLICATE) {
+                sendProtocolReply(PACKET_ACK);
+                if (!pollProtocol()) {
+                    return;
+                }
+            } else if (result == PROTOCOL_ERROR) {
+                sendProtocolReply(PACKET_NAK);
+            } else if (result == PROTOCOL_CLOCK) {
+                sendProtocolReply(PACKET_CLOCK);
+            }
         } else {
-            receivePacket.data[receivePacket.length++] = data;
+            parseSerialByte(data);
         }
-        lastReceivedByte = data;
     }
 }
 
 
 void setup()
 {
-    Serial.begin(BAUD_RATE);        // Open serial port
+    uartBegin(BAUD_RATE);           // Open serial port
+    uploadInit();                   // Resume an upload interrupted by the reset
 
     // I/O-Port configuration
 #ifdef ARDUINO_X4
@@ -171,12 +465,7 @@ void setup()
     // CTC (Mode 4) w/ prescaler 8
     TCCR1B = (1<<WGM12) | (1<<CS11);
     TIMSK |=  (1<<OCIE1A);
-#ifdef ARDUINO_X4
-    OCR1A = 400;    // compare match frequency = 4608 Hz -> LED update frequency = 1152 Hz
-#else
-    // ARDUINO_X8
-    OCR1A = 200;    // compare match frequency = 9216 Hz -> LED update frequency = 1152 Hz
-#endif
+    OCR1A = BAM_UNIT - 1;   // the ISR sets the time of every bitplane
     sei();          // enable global interrupts
 
 #ifdef ARDUINO_X4
@@ -189,12 +478,16 @@ void setup()
 
 void loop()
 {
+    uint8_t frames;
+
+    PROFILE_LOOP_START();
     Button1.update();
 #ifdef ARDUINO_X8
     Button2.update();
 #endif
 
-    serialEvent();
+    processSerialInput();
+    processUpload();
 
     if (Button1.released()) {
         if (state == STATE_EFFECTS) {
@@ -211,7 +504,15 @@ void loop()
     }
 #endif
 
-    processEffect(effectShouldFinish);
+    frames = takeFrames();
+    if (!frames) {
+        PROFILE_LOOP_END();
+        waitForInterrupt();
+        return;
+    }
+    PROFILE_EFFECT_START();
+    processEffect(effectShouldFinish, frames);
+    PROFILE_EFFECT_END();
 
     if(isEffectFinished()) {
         if (requestedState == STATE_SERIAL) {
@@ -229,26 +530,73 @@ void loop()
             startEffect(0);
         }
     }
+    PROFILE_LOOP_END();
 }
 
 // Interrupt routine on Timer1 compare match A
-// Updates LED output
+// Updates LED output: one bitplane of a layer per interrupt (bit-angle modulation)
 ISR(TIMER1_COMPA_vect) {
-    // move on to the next layer
-    if (++current_layer >= LAYER_COUNT) {
-        current_layer = 0;
-        if (++dimCounter > MAX_BRIGHTNESS) {
-            dimCounter = 0;
+    static uint8_t (*planes)[LAYER_COUNT][SCAN_SIZE];      // frame shown in this refresh
+    static bool gray;
+    static uint8_t level;
+    static uint8_t weight;
+    const uint8_t *layer;
+
+    PROFILE_ISR_START();
+    // move on to the next bitplane, after the last one to the next layer
+    if (++current_plane >= BAM_BITS) {
+        current_plane = 0;
+        weight = (1 << (BAM_BITS-1));
+        if (++current_layer >= LAYER_COUNT) {
+            current_layer = 0;
+            // show a presented frame from its first layer on
+            latchFrame();
+            planes = SCAN_BUFFER[frontBuffer];
+            gray = grayBuffer[frontBuffer];
+            level = displayLevel;
+            schedulerTick(REFRESH_TICKS);
         }
+    } else {
+        weight >>= 1;
     }
 
-    if (dimCounter <= brightness) {
+    // this bitplane is shown until the next compare match
+    // (set early, the shortest time is only BAM_UNIT ticks)
+    OCR1A = BAM_UNIT * weight - 1;
+    // Entered late (a USART or EEPROM interrupt ran first): the counter has passed the
+    // compare value already and would run up to 0xFFFF, showing this bitplane for 35 ms.
+    // Let the compare match follow right away instead (TCNT1 counts every 8 cycles).
+    if (TCNT1 >= OCR1A) {
+        OCR1A = TCNT1 + 2;
+    }
+
+    if (gray) {
+        layer = planes[current_plane][current_layer];
+    } else if (level & weight) {
+        layer = planes[0][current_layer];
+    } else {
+        layer = 0;
+    }
+
+    if (layer) {
+#if OUTPUT_BACKEND == OUTPUT_UNROLLED
+        // ARDUINO_X4: PORTD values rendered by present(), ARDUINO_X8: rows
+        SHIFT_OUT(layer[0]);
+        SHIFT_OUT(layer[1]);
+        SHIFT_OUT(layer[2]);
+        SHIFT_OUT(layer[3]);
+        SHIFT_OUT(layer[4]);
+        SHIFT_OUT(layer[5]);
+        SHIFT_OUT(layer[6]);
+        SHIFT_OUT(layer[7]);
+        LATCH_OUT();
+#else
         // Run through all the shift register values and send them
 #ifdef ARDUINO_X4
         for (uint8_t i = 0; i < 2; ++i) {
             for (uint8_t j = 0; j < 8; j+=2) {
                 // set cube state on data output pins
-                PORTD = ((cube[current_layer][i] & (3<<j))<<(6-j));
+                PORTD = ((layer[i] & (3<<j))<<(6-j));
                 // update shift register
                 __asm__("nop\n\t""nop\n\t");
                 PORTC |= (1<<PC0);
@@ -263,7 +611,7 @@ ISR(TIMER1_COMPA_vect) {
 #elif ARDUINO_X8
         for (uint8_t i = 0; i < 8; ++i) {
             // set cube state on data output pins
-            PORTA = cube[current_layer][i];
+            PORTA = layer[i];
             // update shift register
             __asm__("nop\n\t""nop\n\t");
             PORTD |= (1<<PD6);
@@ -274,6 +622,7 @@ ISR(TIMER1_COMPA_vect) {
         PORTD |= (1<<PD7);
         __asm__("nop\n\t""nop\n\t""nop\n\t""nop\n\t");
         PORTD &= ~(1<<PD7);
+#endif
 #endif
 
         // select new layer
@@ -281,4 +630,5 @@ ISR(TIMER1_COMPA_vect) {
     } else {
         PORTC = 0x00;
     }
-};
\ No newline at end of file
+    PROFILE_ISR_END();
+};
@@ -0,0 +1,109 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include "animation.h"
+#include "global.h"
+#include "draw.h"
+
+extern uint8_t (*cube)[LAYER_SIZE];
+
+// The player only keeps its position in the data, a frame is decoded straight into
+// the back buffer.
+struct AnimationPlayer {
+    uint8_t source;
+    const uint8_t *start;       // first frame
+    const uint8_t *position;    // next byte
+    uint16_t frameCount;
+    uint16_t frame;             // next frame
+} player;
+
+// Next byte of the animation
+static inline uint8_t readByte()
+{
+    if (player.source == ANIMATION_EEPROM) {
+        return eeprom_read_byte(player.position++);
+    }
+    return pgm_read_byte(player.position++);
+}
+
+// Start playing the animation at data (address in flash or EEPROM)
+bool animationOpen(uint8_t source, const uint8_t *data)
+{
+    player.source = source;
+    player.position = data;
+    player.frameCount = 0;
+    player.frame = 0;
+    if (readByte() != ANIMATION_MAGIC || readByte() != LAYER_COUNT) {
+        return false;
+    }
+    player.frameCount = readByte();
+    player.frameCount |= readByte() << 8;
+    player.start = player.position;
+    return true;
+}
+
+// Start over with the first frame
+void animationRewind()
+{
+    player.position = player.start;
+    player.frame = 0;
+}
+
+// Decode the next frame into the back buffer
+uint8_t animationNextFrame()
+{
+    uint8_t *data = cube[0];
+    uint16_t remaining = FRAME_SIZE;
+    uint8_t delta;
+    uint8_t duration;
+    uint8_t token;
+    uint8_t count;
+    uint8_t value;
+
+    if (player.frame >= player.frameCount) {
+        return 0;
+    }
+    delta = readByte() & ANIMATION_DELTA;
+    duration = readByte();
+    if (!delta) {
+        // a keyframe replaces a grayscale frame too
+        fill(0x00);
+    }
+
+    while (remaining) {
+        token = readByte();
+        count = (token & 0x7F) + 1;
+        if (count > remaining) {
+            player.frame = player.frameCount;
+            return 0;
+        }
+        remaining -= count;
+        if (token & 0x80) {
+            value = readByte();
+            if (delta) {
+                while (count--) {
+                    *data++ ^= value;
+                }
+            } else {
+                while (count--) {
+                    *data++ = value;
+                }
+            }
+        } else if (delta) {
+            while (count--) {
+                *data++ ^= readByte();
+            }
+        } else {
+            while (count--) {
+                *data++ = readByte();
+            }
+        }
+    }
+    ++player.frame;
+    return duration ? duration : 1;
+}
@@ -0,0 +1,50 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_ANIMATION_H
+#define LEDCUBE_ANIMATION_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+// ---------------------------------------------------------------------------------------
+// Animation container
+// ---------------------------------------------------------------------------------------
+// Stored in flash (PROGMEM) or in the EEPROM, played one frame at a time:
+//
+//   header: 'A' [layer count] [frame count, 2 bytes LSB first]
+//   frame:  [flags] [duration] [PackBits data of FRAME_SIZE bytes]
+//
+// flags:    ANIMATION_DELTA - the data is XORed onto the previous frame,
+//                             otherwise it is the frame itself (keyframe)
+// duration: how long the frame is shown, in frames of the scheduler (1..255)
+// PackBits: token t < 0x80: t+1 literal bytes follow
+//           token t >= 0x80: the next byte repeats (t & 0x7F)+1 times
+// The first frame has to be a keyframe. host/encoder.cpp writes this format.
+
+#define ANIMATION_MAGIC 'A'
+#define ANIMATION_HEADER_SIZE 4
+#define ANIMATION_DELTA 0x01
+
+// Where an animation is stored
+#define ANIMATION_FLASH  0
+#define ANIMATION_EEPROM 1
+
+// Start playing the animation at data (address in flash or EEPROM)
+// Returns false if there is no animation for this cube size.
+bool animationOpen(uint8_t source, const uint8_t *data);
+
+// Start over with the first frame
+void animationRewind();
+
+// Decode the next frame into the back buffer. Returns the duration of the frame,
+// 0 after the last frame or if the data is broken (the back buffer is undefined then).
+uint8_t animationNextFrame();
+
+// Built-in animation in flash (See animations.cpp)
+extern const uint8_t defaultAnimation[] PROGMEM;
+
+#endif
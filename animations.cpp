@@ -0,0 +1,327 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Built-in animation (See animation.h)
+// Generated by "make animations" in the folder host, don't edit.
+
+#include <avr/pgmspace.h>
+#include "animation.h"
+
+#ifdef ARDUINO_X4
+// 4x4x4: 7 frames, 65 bytes
+const uint8_t defaultAnimation[] PROGMEM = {
+    0x41, 0x04, 0x07, 0x00, 0x00, 0x08, 0x00, 0x01, 0x86, 0x00, 0x00, 0x08,
+    0x02, 0x33, 0x00, 0x33, 0x84, 0x00, 0x00, 0x08, 0x07, 0x57, 0x07, 0x05,
+    0x05, 0x57, 0x07, 0x00, 0x00, 0x00, 0x08, 0x07, 0x9F, 0xF9, 0x09, 0x90,
+    0x09, 0x90, 0x9F, 0xF9, 0x00, 0x08, 0x81, 0x00, 0x05, 0xE0, 0xEA, 0xA0,
+    0xA0, 0xE0, 0xEA, 0x00, 0x08, 0x84, 0x00, 0x02, 0xCC, 0x00, 0xCC, 0x00,
+    0x08, 0x86, 0x00, 0x00, 0x80,
+};
+#endif
+
+#ifdef ARDUINO_X8
+// 8x8x8: 15 frames, 440 bytes
+const uint8_t defaultAnimation[] PROGMEM = {
+    0x41, 0x08, 0x0F, 0x00, 0x00, 0x08, 0x00, 0x01, 0xBE, 0x00, 0x00, 0x08,
+    0x81, 0x03, 0x85, 0x00, 0x81, 0x03, 0xB5, 0x00, 0x00, 0x08, 0x02, 0x07,
+    0x05, 0x07, 0x84, 0x00, 0x02, 0x05, 0x00, 0x05, 0x84, 0x00, 0x02, 0x07,
+    0x05, 0x07, 0xAC, 0x00, 0x00, 0x08, 0x03, 0x0F, 0x09, 0x09, 0x0F, 0x83,
+    0x00, 0x03, 0x09, 0x00, 0x00, 0x09, 0x83, 0x00, 0x03, 0x09, 0x00, 0x00,
+    0x09, 0x83, 0x00, 0x03, 0x0F, 0x09, 0x09, 0x0F, 0xA3, 0x00, 0x00, 0x08,
+    0x00, 0x1F, 0x82, 0x11, 0x00, 0x1F, 0x82, 0x00, 0x00, 0x11, 0x82, 0x00,
+    0x00, 0x11, 0x82, 0x00, 0x00, 0x11, 0x82, 0x00, 0x00, 0x11, 0x82, 0x00,
+    0x00, 0x11, 0x82, 0x00, 0x00, 0x11, 0x82, 0x00, 0x00, 0x1F, 0x82, 0x11,
+    0x00, 0x1F, 0x9A, 0x00, 0x00, 0x08, 0x00, 0x3F, 0x83, 0x21, 0x03, 0x3F,
+    0x00, 0x00, 0x21, 0x83, 0x00, 0x03, 0x21, 0x00, 0x00, 0x21, 0x83, 0x00,
+    0x03, 0x21, 0x00, 0x00, 0x21, 0x83, 0x00, 0x03, 0x21, 0x00, 0x00, 0x21,
+    0x83, 0x00, 0x03, 0x21, 0x00, 0x00, 0x3F, 0x83, 0x21, 0x00, 0x3F, 0x91,
+    0x00, 0x00, 0x08, 0x00, 0x7F, 0x84, 0x41, 0x02, 0x7F, 0x00, 0x41, 0x84,
+    0x00, 0x02, 0x41, 0x00, 0x41, 0x84, 0x00, 0x02, 0x41, 0x00, 0x41, 0x84,
+    0x00, 0x02, 0x41, 0x00, 0x41, 0x84, 0x00, 0x02, 0x41, 0x00, 0x41, 0x84,
+    0x00, 0x02, 0x41, 0x00, 0x7F, 0x84, 0x41, 0x00, 0x7F, 0x88, 0x00, 0x00,
+    0x08, 0x00, 0xFF, 0x85, 0x81, 0x01, 0xFF, 0x81, 0x85, 0x00, 0x81, 0x81,
+    0x85, 0x00, 0x81, 0x81, 0x85, 0x00, 0x81, 0x81, 0x85, 0x00, 0x81, 0x81,
+    0x85, 0x00, 0x81, 0x81, 0x85, 0x00, 0x01, 0x81, 0xFF, 0x85, 0x81, 0x00,
+    0xFF, 0x00, 0x08, 0x88, 0x00, 0x00, 0xFE, 0x84, 0x82, 0x02, 0xFE, 0x00,
+    0x82, 0x84, 0x00, 0x02, 0x82, 0x00, 0x82, 0x84, 0x00, 0x02, 0x82, 0x00,
+    0x82, 0x84, 0x00, 0x02, 0x82, 0x00, 0x82, 0x84, 0x00, 0x02, 0x82, 0x00,
+    0x82, 0x84, 0x00, 0x02, 0x82, 0x00, 0xFE, 0x84, 0x82, 0x00, 0xFE, 0x00,
+    0x08, 0x91, 0x00, 0x00, 0xFC, 0x83, 0x84, 0x03, 0xFC, 0x00, 0x00, 0x84,
+    0x83, 0x00, 0x03, 0x84, 0x00, 0x00, 0x84, 0x83, 0x00, 0x03, 0x84, 0x00,
+    0x00, 0x84, 0x83, 0x00, 0x03, 0x84, 0x00, 0x00, 0x84, 0x83, 0x00, 0x03,
+    0x84, 0x00, 0x00, 0xFC, 0x83, 0x84, 0x00, 0xFC, 0x00, 0x08, 0x9A, 0x00,
+    0x00, 0xF8, 0x82, 0x88, 0x00, 0xF8, 0x82, 0x00, 0x00, 0x88, 0x82, 0x00,
+    0x00, 0x88, 0x82, 0x00, 0x00, 0x88, 0x82, 0x00, 0x00, 0x88, 0x82, 0x00,
+    0x00, 0x88, 0x82, 0x00, 0x00, 0x88, 0x82, 0x00, 0x00, 0xF8, 0x82, 0x88,
+    0x00, 0xF8, 0x00, 0x08, 0xA3, 0x00, 0x03, 0xF0, 0x90, 0x90, 0xF0, 0x83,
+    0x00, 0x03, 0x90, 0x00, 0x00, 0x90, 0x83, 0x00, 0x03, 0x90, 0x00, 0x00,
+    0x90, 0x83, 0x00, 0x03, 0xF0, 0x90, 0x90, 0xF0, 0x00, 0x08, 0xAC, 0x00,
+    0x02, 0xE0, 0xA0, 0xE0, 0x84, 0x00, 0x02, 0xA0, 0x00, 0xA0, 0x84, 0x00,
+    0x02, 0xE0, 0xA0, 0xE0, 0x00, 0x08, 0xB5, 0x00, 0x81, 0xC0, 0x85, 0x00,
+    0x81, 0xC0, 0x00, 0x08, 0xBE, 0x00, 0x00, 0x80,
+};
+#endif
+
+#ifdef HOST_X16
+// 16x16x16: 31 frames, 3057 bytes
+const uint8_t defaultAnimation[] PROGMEM = {
+    0x41, 0x10, 0x1F, 0x00, 0x00, 0x08, 0x00, 0x01, 0xFF, 0x00, 0xFF, 0x00,
+    0xFF, 0x00, 0xFE, 0x00, 0x00, 0x08, 0x02, 0x03, 0x00, 0x03, 0x9C, 0x00,
+    0x02, 0x03, 0x00, 0x03, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xDC, 0x00,
+    0x00, 0x08, 0x04, 0x07, 0x00, 0x05, 0x00, 0x07, 0x9A, 0x00, 0x00, 0x05,
+    0x82, 0x00, 0x00, 0x05, 0x9A, 0x00, 0x04, 0x07, 0x00, 0x05, 0x00, 0x07,
+    0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xBA, 0x00, 0x00, 0x08, 0x06, 0x0F,
+    0x00, 0x09, 0x00, 0x09, 0x00, 0x0F, 0x98, 0x00, 0x00, 0x09, 0x84, 0x00,
+    0x00, 0x09, 0x98, 0x00, 0x00, 0x09, 0x84, 0x00, 0x00, 0x09, 0x98, 0x00,
+    0x06, 0x0F, 0x00, 0x09, 0x00, 0x09, 0x00, 0x0F, 0xFF, 0x00, 0xFF, 0x00,
+    0xFF, 0x00, 0x98, 0x00, 0x00, 0x08, 0x08, 0x1F, 0x00, 0x11, 0x00, 0x11,
+    0x00, 0x11, 0x00, 0x1F, 0x96, 0x00, 0x00, 0x11, 0x86, 0x00, 0x00, 0x11,
+    0x96, 0x00, 0x00, 0x11, 0x86, 0x00, 0x00, 0x11, 0x96, 0x00, 0x00, 0x11,
+    0x86, 0x00, 0x00, 0x11, 0x96, 0x00, 0x08, 0x1F, 0x00, 0x11, 0x00, 0x11,
+    0x00, 0x11, 0x00, 0x1F, 0xFF, 0x00, 0xFF, 0x00, 0xF6, 0x00, 0x00, 0x08,
+    0x0A, 0x3F, 0x00, 0x21, 0x00, 0x21, 0x00, 0x21, 0x00, 0x21, 0x00, 0x3F,
+    0x94, 0x00, 0x00, 0x21, 0x88, 0x00, 0x00, 0x21, 0x94, 0x00, 0x00, 0x21,
+    0x88, 0x00, 0x00, 0x21, 0x94, 0x00, 0x00, 0x21, 0x88, 0x00, 0x00, 0x21,
+    0x94, 0x00, 0x00, 0x21, 0x88, 0x00, 0x00, 0x21, 0x94, 0x00, 0x0A, 0x3F,
+    0x00, 0x21, 0x00, 0x21, 0x00, 0x21, 0x00, 0x21, 0x00, 0x3F, 0xFF, 0x00,
+    0xFF, 0x00, 0xD4, 0x00, 0x00, 0x08, 0x0C, 0x7F, 0x00, 0x41, 0x00, 0x41,
+    0x00, 0x41, 0x00, 0x41, 0x00, 0x41, 0x00, 0x7F, 0x92, 0x00, 0x00, 0x41,
+    0x8A, 0x00, 0x00, 0x41, 0x92, 0x00, 0x00, 0x41, 0x8A, 0x00, 0x00, 0x41,
+    0x92, 0x00, 0x00, 0x41, 0x8A, 0x00, 0x00, 0x41, 0x92, 0x00, 0x00, 0x41,
+    0x8A, 0x00, 0x00, 0x41, 0x92, 0x00, 0x00, 0x41, 0x8A, 0x00, 0x00, 0x41,
+    0x92, 0x00, 0x0C, 0x7F, 0x00, 0x41, 0x00, 0x41, 0x00, 0x41, 0x00, 0x41,
+    0x00, 0x41, 0x00, 0x7F, 0xFF, 0x00, 0xFF, 0x00, 0xB2, 0x00, 0x00, 0x08,
+    0x0E, 0xFF, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81,
+    0x00, 0x81, 0x00, 0xFF, 0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00, 0x81,
+    0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x00, 0x81,
+    0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00, 0x81,
+    0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x00, 0x81,
+    0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x0E, 0xFF, 0x00, 0x81, 0x00, 0x81,
+    0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0xFF, 0xFF, 0x00,
+    0xFF, 0x00, 0x90, 0x00, 0x00, 0x08, 0x00, 0xFF, 0x8E, 0x01, 0x01, 0xFF,
+    0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81,
+    0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81,
+    0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81,
+    0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81,
+    0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x81, 0x01, 0x8D, 0x00, 0x00,
+    0xFF, 0x8E, 0x01, 0x01, 0xFF, 0x01, 0xFF, 0x00, 0xED, 0x00, 0x00, 0x08,
+    0x13, 0xFF, 0x03, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01,
+    0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0xFF, 0x03, 0x8B, 0x00, 0x01,
+    0x01, 0x02, 0x8F, 0x00, 0x01, 0x01, 0x02, 0x8B, 0x00, 0x01, 0x01, 0x02,
+    0x8F, 0x00, 0x01, 0x01, 0x02, 0x8B, 0x00, 0x01, 0x01, 0x02, 0x8F, 0x00,
+    0x01, 0x01, 0x02, 0x8B, 0x00, 0x01, 0x01, 0x02, 0x8F, 0x00, 0x01, 0x01,
+    0x02, 0x8B, 0x00, 0x01, 0x01, 0x02, 0x8F, 0x00, 0x01, 0x01, 0x02, 0x8B,
+    0x00, 0x01, 0x01, 0x02, 0x8F, 0x00, 0x01, 0x01, 0x02, 0x8B, 0x00, 0x01,
+    0x01, 0x02, 0x8F, 0x00, 0x01, 0x01, 0x02, 0x8B, 0x00, 0x01, 0x01, 0x02,
+    0x8F, 0x00, 0x01, 0x01, 0x02, 0x8B, 0x00, 0x13, 0xFF, 0x03, 0x01, 0x02,
+    0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02,
+    0x01, 0x02, 0xFF, 0x03, 0xFF, 0x00, 0xCB, 0x00, 0x00, 0x08, 0x15, 0xFF,
+    0x07, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0x01,
+    0x04, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0xFF, 0x07, 0x89, 0x00, 0x01,
+    0x01, 0x04, 0x91, 0x00, 0x01, 0x01, 0x04, 0x89, 0x00, 0x01, 0x01, 0x04,
+    0x91, 0x00, 0x01, 0x01, 0x04, 0x89, 0x00, 0x01, 0x01, 0x04, 0x91, 0x00,
+    0x01, 0x01, 0x04, 0x89, 0x00, 0x01, 0x01, 0x04, 0x91, 0x00, 0x01, 0x01,
+    0x04, 0x89, 0x00, 0x01, 0x01, 0x04, 0x91, 0x00, 0x01, 0x01, 0x04, 0x89,
+    0x00, 0x01, 0x01, 0x04, 0x91, 0x00, 0x01, 0x01, 0x04, 0x89, 0x00, 0x01,
+    0x01, 0x04, 0x91, 0x00, 0x01, 0x01, 0x04, 0x89, 0x00, 0x01, 0x01, 0x04,
+    0x91, 0x00, 0x01, 0x01, 0x04, 0x89, 0x00, 0x01, 0x01, 0x04, 0x91, 0x00,
+    0x01, 0x01, 0x04, 0x89, 0x00, 0x15, 0xFF, 0x07, 0x01, 0x04, 0x01, 0x04,
+    0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04, 0x01, 0x04,
+    0x01, 0x04, 0xFF, 0x07, 0xFF, 0x00, 0xA9, 0x00, 0x00, 0x08, 0x17, 0xFF,
+    0x0F, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01,
+    0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0xFF, 0x0F, 0x87,
+    0x00, 0x01, 0x01, 0x08, 0x93, 0x00, 0x01, 0x01, 0x08, 0x87, 0x00, 0x01,
+    0x01, 0x08, 0x93, 0x00, 0x01, 0x01, 0x08, 0x87, 0x00, 0x01, 0x01, 0x08,
+    0x93, 0x00, 0x01, 0x01, 0x08, 0x87, 0x00, 0x01, 0x01, 0x08, 0x93, 0x00,
+    0x01, 0x01, 0x08, 0x87, 0x00, 0x01, 0x01, 0x08, 0x93, 0x00, 0x01, 0x01,
+    0x08, 0x87, 0x00, 0x01, 0x01, 0x08, 0x93, 0x00, 0x01, 0x01, 0x08, 0x87,
+    0x00, 0x01, 0x01, 0x08, 0x93, 0x00, 0x01, 0x01, 0x08, 0x87, 0x00, 0x01,
+    0x01, 0x08, 0x93, 0x00, 0x01, 0x01, 0x08, 0x87, 0x00, 0x01, 0x01, 0x08,
+    0x93, 0x00, 0x01, 0x01, 0x08, 0x87, 0x00, 0x01, 0x01, 0x08, 0x93, 0x00,
+    0x01, 0x01, 0x08, 0x87, 0x00, 0x17, 0xFF, 0x0F, 0x01, 0x08, 0x01, 0x08,
+    0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08, 0x01, 0x08,
+    0x01, 0x08, 0x01, 0x08, 0xFF, 0x0F, 0xFF, 0x00, 0x87, 0x00, 0x00, 0x08,
+    0x19, 0xFF, 0x1F, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01,
+    0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01,
+    0x10, 0xFF, 0x1F, 0x85, 0x00, 0x01, 0x01, 0x10, 0x95, 0x00, 0x01, 0x01,
+    0x10, 0x85, 0x00, 0x01, 0x01, 0x10, 0x95, 0x00, 0x01, 0x01, 0x10, 0x85,
+    0x00, 0x01, 0x01, 0x10, 0x95, 0x00, 0x01, 0x01, 0x10, 0x85, 0x00, 0x01,
+    0x01, 0x10, 0x95, 0x00, 0x01, 0x01, 0x10, 0x85, 0x00, 0x01, 0x01, 0x10,
+    0x95, 0x00, 0x01, 0x01, 0x10, 0x85, 0x00, 0x01, 0x01, 0x10, 0x95, 0x00,
+    0x01, 0x01, 0x10, 0x85, 0x00, 0x01, 0x01, 0x10, 0x95, 0x00, 0x01, 0x01,
+    0x10, 0x85, 0x00, 0x01, 0x01, 0x10, 0x95, 0x00, 0x01, 0x01, 0x10, 0x85,
+    0x00, 0x01, 0x01, 0x10, 0x95, 0x00, 0x01, 0x01, 0x10, 0x85, 0x00, 0x01,
+    0x01, 0x10, 0x95, 0x00, 0x01, 0x01, 0x10, 0x85, 0x00, 0x01, 0x01, 0x10,
+    0x95, 0x00, 0x01, 0x01, 0x10, 0x85, 0x00, 0x19, 0xFF, 0x1F, 0x01, 0x10,
+    0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10,
+    0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0x01, 0x10, 0xFF, 0x1F, 0xE5, 0x00,
+    0x00, 0x08, 0x1B, 0xFF, 0x3F, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01,
+    0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01,
+    0x20, 0x01, 0x20, 0x01, 0x20, 0xFF, 0x3F, 0x83, 0x00, 0x01, 0x01, 0x20,
+    0x97, 0x00, 0x01, 0x01, 0x20, 0x83, 0x00, 0x01, 0x01, 0x20, 0x97, 0x00,
+    0x01, 0x01, 0x20, 0x83, 0x00, 0x01, 0x01, 0x20, 0x97, 0x00, 0x01, 0x01,
+    0x20, 0x83, 0x00, 0x01, 0x01, 0x20, 0x97, 0x00, 0x01, 0x01, 0x20, 0x83,
+    0x00, 0x01, 0x01, 0x20, 0x97, 0x00, 0x01, 0x01, 0x20, 0x83, 0x00, 0x01,
+    0x01, 0x20, 0x97, 0x00, 0x01, 0x01, 0x20, 0x83, 0x00, 0x01, 0x01, 0x20,
+    0x97, 0x00, 0x01, 0x01, 0x20, 0x83, 0x00, 0x01, 0x01, 0x20, 0x97, 0x00,
+    0x01, 0x01, 0x20, 0x83, 0x00, 0x01, 0x01, 0x20, 0x97, 0x00, 0x01, 0x01,
+    0x20, 0x83, 0x00, 0x01, 0x01, 0x20, 0x97, 0x00, 0x01, 0x01, 0x20, 0x83,
+    0x00, 0x01, 0x01, 0x20, 0x97, 0x00, 0x01, 0x01, 0x20, 0x83, 0x00, 0x01,
+    0x01, 0x20, 0x97, 0x00, 0x01, 0x01, 0x20, 0x83, 0x00, 0x1B, 0xFF, 0x3F,
+    0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20,
+    0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20, 0x01, 0x20,
+    0xFF, 0x3F, 0xC3, 0x00, 0x00, 0x08, 0x21, 0xFF, 0x7F, 0x01, 0x40, 0x01,
+    0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01,
+    0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0xFF,
+    0x7F, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x05, 0x01, 0x40, 0x00, 0x00,
+    0x01, 0x40, 0x99, 0x00, 0x05, 0x01, 0x40, 0x00, 0x00, 0x01, 0x40, 0x99,
+    0x00, 0x05, 0x01, 0x40, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x05, 0x01,
+    0x40, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x05, 0x01, 0x40, 0x00, 0x00,
+    0x01, 0x40, 0x99, 0x00, 0x05, 0x01, 0x40, 0x00, 0x00, 0x01, 0x40, 0x99,
+    0x00, 0x05, 0x01, 0x40, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x05, 0x01,
+    0x40, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x05, 0x01, 0x40, 0x00, 0x00,
+    0x01, 0x40, 0x99, 0x00, 0x05, 0x01, 0x40, 0x00, 0x00, 0x01, 0x40, 0x99,
+    0x00, 0x05, 0x01, 0x40, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x05, 0x01,
+    0x40, 0x00, 0x00, 0x01, 0x40, 0x99, 0x00, 0x21, 0x01, 0x40, 0x00, 0x00,
+    0xFF, 0x7F, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40,
+    0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40, 0x01, 0x40,
+    0x01, 0x40, 0x01, 0x40, 0xFF, 0x7F, 0xA1, 0x00, 0x00, 0x08, 0x81, 0xFF,
+    0x1F, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01,
+    0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01,
+    0x80, 0x01, 0x80, 0x01, 0x80, 0xFF, 0xFF, 0x01, 0x80, 0x9B, 0x00, 0x03,
+    0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x03, 0x01, 0x80, 0x01, 0x80, 0x9B,
+    0x00, 0x03, 0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x03, 0x01, 0x80, 0x01,
+    0x80, 0x9B, 0x00, 0x03, 0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x03, 0x01,
+    0x80, 0x01, 0x80, 0x9B, 0x00, 0x03, 0x01, 0x80, 0x01, 0x80, 0x9B, 0x00,
+    0x03, 0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x03, 0x01, 0x80, 0x01, 0x80,
+    0x9B, 0x00, 0x03, 0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x03, 0x01, 0x80,
+    0x01, 0x80, 0x9B, 0x00, 0x03, 0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x03,
+    0x01, 0x80, 0x01, 0x80, 0x9B, 0x00, 0x21, 0x01, 0x80, 0xFF, 0xFF, 0x01,
+    0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01,
+    0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01, 0x80, 0x01,
+    0x80, 0x01, 0x80, 0xFF, 0xFF, 0x00, 0x08, 0xA1, 0x00, 0x21, 0xFE, 0xFF,
+    0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80,
+    0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80,
+    0x02, 0x80, 0xFE, 0xFF, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x05, 0x02,
+    0x80, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x05, 0x02, 0x80, 0x00, 0x00,
+    0x02, 0x80, 0x99, 0x00, 0x05, 0x02, 0x80, 0x00, 0x00, 0x02, 0x80, 0x99,
+    0x00, 0x05, 0x02, 0x80, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x05, 0x02,
+    0x80, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x05, 0x02, 0x80, 0x00, 0x00,
+    0x02, 0x80, 0x99, 0x00, 0x05, 0x02, 0x80, 0x00, 0x00, 0x02, 0x80, 0x99,
+    0x00, 0x05, 0x02, 0x80, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x05, 0x02,
+    0x80, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x05, 0x02, 0x80, 0x00, 0x00,
+    0x02, 0x80, 0x99, 0x00, 0x05, 0x02, 0x80, 0x00, 0x00, 0x02, 0x80, 0x99,
+    0x00, 0x05, 0x02, 0x80, 0x00, 0x00, 0x02, 0x80, 0x99, 0x00, 0x21, 0x02,
+    0x80, 0x00, 0x00, 0xFE, 0xFF, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02,
+    0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0x02,
+    0x80, 0x02, 0x80, 0x02, 0x80, 0x02, 0x80, 0xFE, 0xFF, 0x00, 0x08, 0xC3,
+    0x00, 0x1B, 0xFC, 0xFF, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80,
+    0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80,
+    0x04, 0x80, 0x04, 0x80, 0xFC, 0xFF, 0x83, 0x00, 0x01, 0x04, 0x80, 0x97,
+    0x00, 0x01, 0x04, 0x80, 0x83, 0x00, 0x01, 0x04, 0x80, 0x97, 0x00, 0x01,
+    0x04, 0x80, 0x83, 0x00, 0x01, 0x04, 0x80, 0x97, 0x00, 0x01, 0x04, 0x80,
+    0x83, 0x00, 0x01, 0x04, 0x80, 0x97, 0x00, 0x01, 0x04, 0x80, 0x83, 0x00,
+    0x01, 0x04, 0x80, 0x97, 0x00, 0x01, 0x04, 0x80, 0x83, 0x00, 0x01, 0x04,
+    0x80, 0x97, 0x00, 0x01, 0x04, 0x80, 0x83, 0x00, 0x01, 0x04, 0x80, 0x97,
+    0x00, 0x01, 0x04, 0x80, 0x83, 0x00, 0x01, 0x04, 0x80, 0x97, 0x00, 0x01,
+    0x04, 0x80, 0x83, 0x00, 0x01, 0x04, 0x80, 0x97, 0x00, 0x01, 0x04, 0x80,
+    0x83, 0x00, 0x01, 0x04, 0x80, 0x97, 0x00, 0x01, 0x04, 0x80, 0x83, 0x00,
+    0x01, 0x04, 0x80, 0x97, 0x00, 0x01, 0x04, 0x80, 0x83, 0x00, 0x01, 0x04,
+    0x80, 0x97, 0x00, 0x01, 0x04, 0x80, 0x83, 0x00, 0x1B, 0xFC, 0xFF, 0x04,
+    0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04,
+    0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0x04, 0x80, 0xFC,
+    0xFF, 0x00, 0x08, 0xE5, 0x00, 0x19, 0xF8, 0xFF, 0x08, 0x80, 0x08, 0x80,
+    0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80,
+    0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0xF8, 0xFF, 0x85, 0x00, 0x01, 0x08,
+    0x80, 0x95, 0x00, 0x01, 0x08, 0x80, 0x85, 0x00, 0x01, 0x08, 0x80, 0x95,
+    0x00, 0x01, 0x08, 0x80, 0x85, 0x00, 0x01, 0x08, 0x80, 0x95, 0x00, 0x01,
+    0x08, 0x80, 0x85, 0x00, 0x01, 0x08, 0x80, 0x95, 0x00, 0x01, 0x08, 0x80,
+    0x85, 0x00, 0x01, 0x08, 0x80, 0x95, 0x00, 0x01, 0x08, 0x80, 0x85, 0x00,
+    0x01, 0x08, 0x80, 0x95, 0x00, 0x01, 0x08, 0x80, 0x85, 0x00, 0x01, 0x08,
+    0x80, 0x95, 0x00, 0x01, 0x08, 0x80, 0x85, 0x00, 0x01, 0x08, 0x80, 0x95,
+    0x00, 0x01, 0x08, 0x80, 0x85, 0x00, 0x01, 0x08, 0x80, 0x95, 0x00, 0x01,
+    0x08, 0x80, 0x85, 0x00, 0x01, 0x08, 0x80, 0x95, 0x00, 0x01, 0x08, 0x80,
+    0x85, 0x00, 0x01, 0x08, 0x80, 0x95, 0x00, 0x01, 0x08, 0x80, 0x85, 0x00,
+    0x19, 0xF8, 0xFF, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08,
+    0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08, 0x80, 0x08,
+    0x80, 0xF8, 0xFF, 0x00, 0x08, 0xFF, 0x00, 0x87, 0x00, 0x17, 0xF0, 0xFF,
+    0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80,
+    0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0xF0, 0xFF, 0x87, 0x00,
+    0x01, 0x10, 0x80, 0x93, 0x00, 0x01, 0x10, 0x80, 0x87, 0x00, 0x01, 0x10,
+    0x80, 0x93, 0x00, 0x01, 0x10, 0x80, 0x87, 0x00, 0x01, 0x10, 0x80, 0x93,
+    0x00, 0x01, 0x10, 0x80, 0x87, 0x00, 0x01, 0x10, 0x80, 0x93, 0x00, 0x01,
+    0x10, 0x80, 0x87, 0x00, 0x01, 0x10, 0x80, 0x93, 0x00, 0x01, 0x10, 0x80,
+    0x87, 0x00, 0x01, 0x10, 0x80, 0x93, 0x00, 0x01, 0x10, 0x80, 0x87, 0x00,
+    0x01, 0x10, 0x80, 0x93, 0x00, 0x01, 0x10, 0x80, 0x87, 0x00, 0x01, 0x10,
+    0x80, 0x93, 0x00, 0x01, 0x10, 0x80, 0x87, 0x00, 0x01, 0x10, 0x80, 0x93,
+    0x00, 0x01, 0x10, 0x80, 0x87, 0x00, 0x01, 0x10, 0x80, 0x93, 0x00, 0x01,
+    0x10, 0x80, 0x87, 0x00, 0x17, 0xF0, 0xFF, 0x10, 0x80, 0x10, 0x80, 0x10,
+    0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10,
+    0x80, 0x10, 0x80, 0xF0, 0xFF, 0x00, 0x08, 0xFF, 0x00, 0xA9, 0x00, 0x15,
+    0xE0, 0xFF, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80,
+    0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0xE0, 0xFF, 0x89, 0x00,
+    0x01, 0x20, 0x80, 0x91, 0x00, 0x01, 0x20, 0x80, 0x89, 0x00, 0x01, 0x20,
+    0x80, 0x91, 0x00, 0x01, 0x20, 0x80, 0x89, 0x00, 0x01, 0x20, 0x80, 0x91,
+    0x00, 0x01, 0x20, 0x80, 0x89, 0x00, 0x01, 0x20, 0x80, 0x91, 0x00, 0x01,
+    0x20, 0x80, 0x89, 0x00, 0x01, 0x20, 0x80, 0x91, 0x00, 0x01, 0x20, 0x80,
+    0x89, 0x00, 0x01, 0x20, 0x80, 0x91, 0x00, 0x01, 0x20, 0x80, 0x89, 0x00,
+    0x01, 0x20, 0x80, 0x91, 0x00, 0x01, 0x20, 0x80, 0x89, 0x00, 0x01, 0x20,
+    0x80, 0x91, 0x00, 0x01, 0x20, 0x80, 0x89, 0x00, 0x01, 0x20, 0x80, 0x91,
+    0x00, 0x01, 0x20, 0x80, 0x89, 0x00, 0x15, 0xE0, 0xFF, 0x20, 0x80, 0x20,
+    0x80, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0x20, 0x80, 0x20,
+    0x80, 0x20, 0x80, 0xE0, 0xFF, 0x00, 0x08, 0xFF, 0x00, 0xCB, 0x00, 0x13,
+    0xC0, 0xFF, 0x40, 0x80, 0x40, 0x80, 0x40, 0x80, 0x40, 0x80, 0x40, 0x80,
+    0x40, 0x80, 0x40, 0x80, 0x40, 0x80, 0xC0, 0xFF, 0x8B, 0x00, 0x01, 0x40,
+    0x80, 0x8F, 0x00, 0x01, 0x40, 0x80, 0x8B, 0x00, 0x01, 0x40, 0x80, 0x8F,
+    0x00, 0x01, 0x40, 0x80, 0x8B, 0x00, 0x01, 0x40, 0x80, 0x8F, 0x00, 0x01,
+    0x40, 0x80, 0x8B, 0x00, 0x01, 0x40, 0x80, 0x8F, 0x00, 0x01, 0x40, 0x80,
+    0x8B, 0x00, 0x01, 0x40, 0x80, 0x8F, 0x00, 0x01, 0x40, 0x80, 0x8B, 0x00,
+    0x01, 0x40, 0x80, 0x8F, 0x00, 0x01, 0x40, 0x80, 0x8B, 0x00, 0x01, 0x40,
+    0x80, 0x8F, 0x00, 0x01, 0x40, 0x80, 0x8B, 0x00, 0x01, 0x40, 0x80, 0x8F,
+    0x00, 0x01, 0x40, 0x80, 0x8B, 0x00, 0x13, 0xC0, 0xFF, 0x40, 0x80, 0x40,
+    0x80, 0x40, 0x80, 0x40, 0x80, 0x40, 0x80, 0x40, 0x80, 0x40, 0x80, 0x40,
+    0x80, 0xC0, 0xFF, 0x00, 0x08, 0xFF, 0x00, 0xED, 0x00, 0x01, 0x80, 0xFF,
+    0x8E, 0x80, 0x00, 0xFF, 0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80,
+    0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80,
+    0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80,
+    0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80,
+    0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80, 0x8D, 0x00, 0x81, 0x80,
+    0x8D, 0x00, 0x01, 0x80, 0xFF, 0x8E, 0x80, 0x00, 0xFF, 0x00, 0x08, 0xFF,
+    0x00, 0xFF, 0x00, 0x90, 0x00, 0x0E, 0xFF, 0x00, 0x81, 0x00, 0x81, 0x00,
+    0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0xFF, 0x90, 0x00, 0x00,
+    0x81, 0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00,
+    0x81, 0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x00,
+    0x81, 0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00,
+    0x81, 0x90, 0x00, 0x00, 0x81, 0x8C, 0x00, 0x00, 0x81, 0x90, 0x00, 0x0E,
+    0xFF, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00,
+    0x81, 0x00, 0xFF, 0x00, 0x08, 0xFF, 0x00, 0xFF, 0x00, 0xB2, 0x00, 0x0C,
+    0xFE, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00,
+    0xFE, 0x92, 0x00, 0x00, 0x82, 0x8A, 0x00, 0x00, 0x82, 0x92, 0x00, 0x00,
+    0x82, 0x8A, 0x00, 0x00, 0x82, 0x92, 0x00, 0x00, 0x82, 0x8A, 0x00, 0x00,
+    0x82, 0x92, 0x00, 0x00, 0x82, 0x8A, 0x00, 0x00, 0x82, 0x92, 0x00, 0x00,
+    0x82, 0x8A, 0x00, 0x00, 0x82, 0x92, 0x00, 0x0C, 0xFE, 0x00, 0x82, 0x00,
+    0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0xFE, 0x00, 0x08, 0xFF,
+    0x00, 0xFF, 0x00, 0xD4, 0x00, 0x0A, 0xFC, 0x00, 0x84, 0x00, 0x84, 0x00,
+    0x84, 0x00, 0x84, 0x00, 0xFC, 0x94, 0x00, 0x00, 0x84, 0x88, 0x00, 0x00,
+    0x84, 0x94, 0x00, 0x00, 0x84, 0x88, 0x00, 0x00, 0x84, 0x94, 0x00, 0x00,
+    0x84, 0x88, 0x00, 0x00, 0x84, 0x94, 0x00, 0x00, 0x84, 0x88, 0x00, 0x00,
+    0x84, 0x94, 0x00, 0x0A, 0xFC, 0x00, 0x84, 0x00, 0x84, 0x00, 0x84, 0x00,
+    0x84, 0x00, 0xFC, 0x00, 0x08, 0xFF, 0x00, 0xFF, 0x00, 0xF6, 0x00, 0x08,
+    0xF8, 0x00, 0x88, 0x00, 0x88, 0x00, 0x88, 0x00, 0xF8, 0x96, 0x00, 0x00,
+    0x88, 0x86, 0x00, 0x00, 0x88, 0x96, 0x00, 0x00, 0x88, 0x86, 0x00, 0x00,
+    0x88, 0x96, 0x00, 0x00, 0x88, 0x86, 0x00, 0x00, 0x88, 0x96, 0x00, 0x08,
+    0xF8, 0x00, 0x88, 0x00, 0x88, 0x00, 0x88, 0x00, 0xF8, 0x00, 0x08, 0xFF,
+    0x00, 0xFF, 0x00, 0xFF, 0x00, 0x98, 0x00, 0x06, 0xF0, 0x00, 0x90, 0x00,
+    0x90, 0x00, 0xF0, 0x98, 0x00, 0x00, 0x90, 0x84, 0x00, 0x00, 0x90, 0x98,
+    0x00, 0x00, 0x90, 0x84, 0x00, 0x00, 0x90, 0x98, 0x00, 0x06, 0xF0, 0x00,
+    0x90, 0x00, 0x90, 0x00, 0xF0, 0x00, 0x08, 0xFF, 0x00, 0xFF, 0x00, 0xFF,
+    0x00, 0xBA, 0x00, 0x04, 0xE0, 0x00, 0xA0, 0x00, 0xE0, 0x9A, 0x00, 0x00,
+    0xA0, 0x82, 0x00, 0x00, 0xA0, 0x9A, 0x00, 0x04, 0xE0, 0x00, 0xA0, 0x00,
+    0xE0, 0x00, 0x08, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xDC, 0x00, 0x02,
+    0xC0, 0x00, 0xC0, 0x9C, 0x00, 0x02, 0xC0, 0x00, 0xC0, 0x00, 0x08, 0xFF,
+    0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFE, 0x00, 0x00, 0x80,
+};
+#endif
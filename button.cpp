@@ -4,7 +4,7 @@
  * Email:   sandro.lutz@temparus.ch
  */
 
-#include "Button.h"
+#include "button.h"
 
 #define DEBOUNCED_STATE 0
 #define UNSTABLE_STATE  1
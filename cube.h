@@ -0,0 +1,861 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_CUBE_H
+#define LEDCUBE_CUBE_H
+
+#include <Arduino.h>
+#include "draw.h"
+
+// Row of voxels along the X axis (bit x is voxel x). Wide holds a row shifted by up
+// to N-1 voxels.
+template <uint8_t N> struct CubeRow { typedef uint8_t Type; typedef uint16_t Wide; };
+template <> struct CubeRow<16> { typedef uint16_t Type; typedef uint32_t Wide; };
+
+// ---------------------------------------------------------------------------------------
+// Cube<N>
+// ---------------------------------------------------------------------------------------
+// Voxel, plane, box, line and shift code for a cube of N*N*N voxels. It only consists of
+// this header, so the compiler generates code specialized for the cube size and all the
+// size dependent branches are resolved at compile time.
+// A frame consists of N layers (z). Every layer is a bitmap of N*N bits, row (y) after
+// row, starting with bit 0 of the first byte for voxel x=0:
+//   N=4:  2 bytes per layer, the low nibble holds the even row (LAYER2__LAYER1)
+//   N=8:  one byte per row
+//   N=16: two bytes per row (host builds only)
+// The functions draw into the frame they get (See cube in draw.cpp).
+
+template <uint8_t N>
+struct Cube
+{
+    static_assert(N == 4 || N == 8 || N == 16, "Supported cube sizes are 4, 8 and 16");
+
+    typedef typename CubeRow<N>::Type Row;
+    typedef typename CubeRow<N>::Wide Wide;
+
+    static constexpr uint8_t SIZE = N;
+    static constexpr uint8_t LAYER_BYTES = N*N/8;            // bytes per layer
+    static constexpr uint16_t FRAME_BYTES = N*LAYER_BYTES;
+    static constexpr uint8_t ROWS_PER_BYTE = N < 8 ? 8/N : 1;
+    static constexpr uint8_t BYTES_PER_ROW = N < 8 ? 1 : N/8;
+    static constexpr Row FULL_ROW = (Row)~(Row)0 >> (8*sizeof(Row) - N);
+    // Multiplied with a row, gives a byte with this row in every row the byte holds
+    static constexpr uint8_t ROW_REPEAT = N < 8 ? 0x11 : 0x01;
+
+    typedef uint8_t Layer[LAYER_BYTES];
+
+    // This function checks if the coordinate is valid
+    // Because using uint8_t, only the upper limit needs to be checked.
+    static inline bool inRange(uint8_t x, uint8_t y, uint8_t z)
+    {
+        return x < N && y < N && z < N;
+    }
+
+    // Byte of a voxel within its layer (no range check)
+    static inline uint8_t voxelIndex(uint8_t x, uint8_t y)
+    {
+        if (N < 8) {
+            return y / ROWS_PER_BYTE;
+        } else if (N == 8) {
+            return y;
+        }
+        return y*BYTES_PER_ROW + x/8;
+    }
+
+    // Bit of a voxel within its byte (no range check)
+    static inline uint8_t voxelMask(uint8_t x, uint8_t y)
+    {
+        if (N < 8) {
+            return 1 << (x + (y % ROWS_PER_BYTE)*N);
+        }
+        return 1 << (x % 8);
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Rows (no range check)
+    // -----------------------------------------------------------------------------------
+
+    // Get row y of layer z
+    static inline Row getRow(const Layer *frame, uint8_t y, uint8_t z)
+    {
+        if (N < 8) {
+            return (frame[z][y/ROWS_PER_BYTE] >> ((y % ROWS_PER_BYTE)*N)) & FULL_ROW;
+        } else if (N == 8) {
+            return frame[z][y];
+        }
+        return frame[z][y*BYTES_PER_ROW] | (Row)(frame[z][y*BYTES_PER_ROW+1] << 8);
+    }
+
+    // Replace row y of layer z
+    static inline void setRow(Layer *frame, uint8_t y, uint8_t z, Row row)
+    {
+        if (N < 8) {
+            uint8_t shift = (y % ROWS_PER_BYTE)*N;
+            uint8_t *data = &frame[z][y/ROWS_PER_BYTE];
+            *data = (*data & ~(FULL_ROW << shift)) | (row << shift);
+        } else if (N == 8) {
+            frame[z][y] = row;
+        } else {
+            frame[z][y*BYTES_PER_ROW] = row;
+            frame[z][y*BYTES_PER_ROW+1] = row >> 8;
+        }
+    }
+
+    // Set the voxels of a mask in row y of layer z
+    static inline void orRow(Layer *frame, uint8_t y, uint8_t z, Row mask)
+    {
+        if (N < 8) {
+            frame[z][y/ROWS_PER_BYTE] |= mask << ((y % ROWS_PER_BYTE)*N);
+        } else if (N == 8) {
+            frame[z][y] |= mask;
+        } else {
+            frame[z][y*BYTES_PER_ROW] |= mask;
+            frame[z][y*BYTES_PER_ROW+1] |= mask >> 8;
+        }
+    }
+
+    // Clear the voxels of a mask in row y of layer z
+    static inline void clrRow(Layer *frame, uint8_t y, uint8_t z, Row mask)
+    {
+        if (N < 8) {
+            frame[z][y/ROWS_PER_BYTE] &= ~(mask << ((y % ROWS_PER_BYTE)*N));
+        } else if (N == 8) {
+            frame[z][y] &= ~mask;
+        } else {
+            frame[z][y*BYTES_PER_ROW] &= ~mask;
+            frame[z][y*BYTES_PER_ROW+1] &= ~(mask >> 8);
+        }
+    }
+
+    // Toggle the voxels of a mask in row y of layer z
+    static inline void xorRow(Layer *frame, uint8_t y, uint8_t z, Row mask)
+    {
+        if (N < 8) {
+            frame[z][y/ROWS_PER_BYTE] ^= mask << ((y % ROWS_PER_BYTE)*N);
+        } else if (N == 8) {
+            frame[z][y] ^= mask;
+        } else {
+            frame[z][y*BYTES_PER_ROW] ^= mask;
+            frame[z][y*BYTES_PER_ROW+1] ^= mask >> 8;
+        }
+    }
+
+    // Returns a row with the voxels x1..x2 set
+    static inline Row rowLine(uint8_t x1, uint8_t x2)
+    {
+        return (Row)(FULL_ROW << x1) & (Row)(FULL_ROW >> (N-1-x2));
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Voxels
+    // -----------------------------------------------------------------------------------
+
+    // Turn on a single voxel
+    static inline void setVoxel(Layer *frame, uint8_t x, uint8_t y, uint8_t z)
+    {
+        if (inRange(x,y,z)) {
+            frame[z][voxelIndex(x,y)] |= voxelMask(x,y);
+        }
+    }
+
+    // Turn off a single voxel
+    static inline void clrVoxel(Layer *frame, uint8_t x, uint8_t y, uint8_t z)
+    {
+        if (inRange(x,y,z)) {
+            frame[z][voxelIndex(x,y)] &= ~voxelMask(x,y);
+        }
+    }
+
+    // Toggle a single voxel
+    static inline void toggleVoxel(Layer *frame, uint8_t x, uint8_t y, uint8_t z)
+    {
+        if (inRange(x,y,z)) {
+            frame[z][voxelIndex(x,y)] ^= voxelMask(x,y);
+        }
+    }
+
+    // Get the current status of a voxel
+    static inline uint8_t getVoxel(const Layer *frame, uint8_t x, uint8_t y, uint8_t z)
+    {
+        if (inRange(x,y,z) && (frame[z][voxelIndex(x,y)] & voxelMask(x,y))) {
+            return 0x01;
+        }
+        return 0x00;
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Planes
+    // -----------------------------------------------------------------------------------
+
+    // Fill the whole frame with a pattern
+    static inline void fill(Layer *frame, uint8_t pattern)
+    {
+        memset(frame, pattern, FRAME_BYTES);
+    }
+
+    // Set all voxels along a Y/Z plane at a given point on axis X
+    static void setPlaneX(Layer *frame, uint8_t x)
+    {
+        uint8_t *data = frame[0];
+        uint8_t mask = ROW_REPEAT * (1 << (x % 8));
+        uint16_t i;
+
+        if (x < N) {
+            for (i = (N > 8 ? x/8 : 0); i < FRAME_BYTES; i += BYTES_PER_ROW) {
+                data[i] |= mask;
+            }
+        }
+    }
+
+    // Clear voxels in the same manner as above
+    static void clrPlaneX(Layer *frame, uint8_t x)
+    {
+        uint8_t *data = frame[0];
+        uint8_t mask = ROW_REPEAT * (1 << (x % 8));
+        uint16_t i;
+
+        if (x < N) {
+            for (i = (N > 8 ? x/8 : 0); i < FRAME_BYTES; i += BYTES_PER_ROW) {
+                data[i] &= ~mask;
+            }
+        }
+    }
+
+    // Set all voxels along a X/Z plane at a given point on axis Y
+    static void setPlaneY(Layer *frame, uint8_t y)
+    {
+        uint8_t z;
+
+        if (y < N) {
+            for (z = 0; z < N; ++z) {
+                orRow(frame, y, z, FULL_ROW);
+            }
+        }
+    }
+
+    // Clear voxels in the same manner as above
+    static void clrPlaneY(Layer *frame, uint8_t y)
+    {
+        uint8_t z;
+
+        if (y < N) {
+            for (z = 0; z < N; ++z) {
+                clrRow(frame, y, z, FULL_ROW);
+            }
+        }
+    }
+
+    // Set all voxels along a X/Y plane at a given point on axis Z
+    static inline void setPlaneZ(Layer *frame, uint8_t z)
+    {
+        if (z < N) {
+            memset(frame[z], 0xFF, LAYER_BYTES);
+        }
+    }
+
+    // Clear voxels in the same manner as above
+    static inline void clrPlaneZ(Layer *frame, uint8_t z)
+    {
+        if (z < N) {
+            memset(frame[z], 0x00, LAYER_BYTES);
+        }
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Shapes
+    // -----------------------------------------------------------------------------------
+
+    // Draw a box (See box() in draw.h)
+    static void box(Layer *frame, uint8_t type, uint8_t x1, uint8_t y1, uint8_t z1,
+                    uint8_t x2, uint8_t y2, uint8_t z2)
+    {
+        uint8_t i;
+        uint8_t j;
+        Row row;
+
+        if (!inRange(x1,y1,z1) || !inRange(x2,y2,z2)) {
+            return;
+        }
+        orderValues(&x1, &x2);
+        orderValues(&y1, &y2);
+        orderValues(&z1, &z2);
+        row = rowLine(x1, x2);
+
+        if (type == BOX_FILLED)
+        {
+            for (i = z1; i <= z2; ++i) {
+                for (j = y1; j <= y2; ++j) {
+                    orRow(frame, j, i, row);
+                }
+            }
+        }
+        else if (type == BOX_WALLS)
+        {
+            for (i = z1; i <= z2; ++i) {
+                for (j = y1; j <= y2; ++j) {
+                    if (j == y1 || j == y2 || i == z1 || i == z2) {
+                        setRow(frame, j, i, row);
+                    } else {
+                        orRow(frame, j, i, (Row)((Row)1 << x1) | (Row)((Row)1 << x2));
+                    }
+                }
+            }
+        }
+        else if (type == BOX_FRAME)
+        {
+            // Lines along X axis
+            setRow(frame, y1, z1, row);
+            setRow(frame, y2, z1, row);
+            setRow(frame, y1, z2, row);
+            setRow(frame, y2, z2, row);
+
+            // Lines along Y axis
+            for (j = y1; j <= y2; ++j) {
+                setVoxel(frame, x1, j, z1);
+                setVoxel(frame, x1, j, z2);
+                setVoxel(frame, x2, j, z1);
+                setVoxel(frame, x2, j, z2);
+            }
+
+            // Lines along Z axis
+            for (i = z1; i <= z2; ++i) {
+                setVoxel(frame, x1, y1, i);
+                setVoxel(frame, x1, y2, i);
+                setVoxel(frame, x2, y1, i);
+                setVoxel(frame, x2, y2, i);
+            }
+        }
+    }
+
+    // Draws a line between two coordinates in 3D space
+    // Integer 3D Bresenham: the axis with the largest distance is stepped voxel by voxel,
+    // the other two axes follow using error terms. Along the X axis, voxels which end up
+    // in the same row are collected in a mask and written with a single access.
+    static void line(Layer *frame, uint8_t x1, uint8_t y1, uint8_t z1,
+                     uint8_t x2, uint8_t y2, uint8_t z2)
+    {
+        uint8_t dx, dy, dz;
+        int8_t sx, sy, sz;
+        int8_t ex, ey, ez;
+        Row bit;
+        Row mask;
+
+        if (!inRange(x1,y1,z1) || !inRange(x2,y2,z2)) {
+            return;
+        }
+
+        if (x2 >= x1) { dx = x2 - x1; sx = 1; } else { dx = x1 - x2; sx = -1; }
+        if (y2 >= y1) { dy = y2 - y1; sy = 1; } else { dy = y1 - y2; sy = -1; }
+        if (z2 >= z1) { dz = z2 - z1; sz = 1; } else { dz = z1 - z2; sz = -1; }
+
+        bit = (Row)1 << x1;
+
+        if (dx >= dy && dx >= dz)
+        {
+            // X is the major axis: collect the voxels of a row
+            ey = 2*dy - dx;
+            ez = 2*dz - dx;
+            mask = 0;
+            for (;;) {
+                mask |= bit;
+                if (x1 == x2) {
+                    break;
+                }
+                x1 += sx;
+                bit = (sx > 0) ? (Row)(bit << 1) : (Row)(bit >> 1);
+                if (ey >= 0 || ez >= 0) {
+                    orRow(frame, y1, z1, mask);
+                    mask = 0;
+                    if (ey >= 0) {
+                        y1 += sy;
+                        ey -= 2*dx;
+                    }
+                    if (ez >= 0) {
+                        z1 += sz;
+                        ez -= 2*dx;
+                    }
+                }
+                ey += 2*dy;
+                ez += 2*dz;
+            }
+            orRow(frame, y1, z1, mask);
+        }
+        else if (dy >= dz)
+        {
+            // Y is the major axis: every voxel is in another row
+            ex = 2*dx - dy;
+            ez = 2*dz - dy;
+            for (;;) {
+                orRow(frame, y1, z1, bit);
+                if (y1 == y2) {
+                    break;
+                }
+                y1 += sy;
+                if (ex >= 0) {
+                    bit = (sx > 0) ? (Row)(bit << 1) : (Row)(bit >> 1);
+                    ex -= 2*dy;
+                }
+                if (ez >= 0) {
+                    z1 += sz;
+                    ez -= 2*dy;
+                }
+                ex += 2*dx;
+                ez += 2*dz;
+            }
+        }
+        else
+        {
+            // Z is the major axis: every voxel is in another layer
+            ex = 2*dx - dz;
+            ey = 2*dy - dz;
+            for (;;) {
+                orRow(frame, y1, z1, bit);
+                if (z1 == z2) {
+                    break;
+                }
+                z1 += sz;
+                if (ex >= 0) {
+                    bit = (sx > 0) ? (Row)(bit << 1) : (Row)(bit >> 1);
+                    ex -= 2*dz;
+                }
+                if (ey >= 0) {
+                    y1 += sy;
+                    ey -= 2*dz;
+                }
+                ex += 2*dx;
+                ey += 2*dy;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Moving the content
+    // -----------------------------------------------------------------------------------
+
+    // Moves the content by one voxel along an axis. Direction -1 moves it towards 0,
+    // +1 away from 0. The plane which gets empty is either cleared or, with wrap set,
+    // receives the plane which moved out of the cube on the other side.
+    static void moveContent(Layer *frame, uint8_t axis, int8_t direction, bool wrap)
+    {
+        uint8_t edge[LAYER_BYTES];
+        uint8_t carry = wrap ? 0xFF : 0x00;
+        uint8_t *data;
+        uint8_t z;
+        uint16_t i;
+
+        if (axis == AXIS_Z)
+        {
+            // whole layers
+            if (direction < 0) {
+                memcpy(edge, frame[0], LAYER_BYTES);
+                memmove(frame[0], frame[1], (N-1)*LAYER_BYTES);
+                if (wrap) {
+                    memcpy(frame[N-1], edge, LAYER_BYTES);
+                } else {
+                    memset(frame[N-1], 0x00, LAYER_BYTES);
+                }
+            } else {
+                memcpy(edge, frame[N-1], LAYER_BYTES);
+                memmove(frame[1], frame[0], (N-1)*LAYER_BYTES);
+                if (wrap) {
+                    memcpy(frame[0], edge, LAYER_BYTES);
+                } else {
+                    memset(frame[0], 0x00, LAYER_BYTES);
+                }
+            }
+        }
+        else if (axis == AXIS_Y)
+        {
+            // whole rows within each layer
+            for (z = 0; z < N; ++z) {
+                data = frame[z];
+                if (N < 8) {
+                    // the rows of a layer are the nibbles of a 16 bit value
+                    uint16_t layer = data[0] | (data[1] << 8);
+                    if (direction < 0) {
+                        layer = (layer >> N) | (wrap ? (layer << (N < 8 ? N*(N-1) : 0)) : 0);
+                    } else {
+                        layer = (layer << N) | (wrap ? (layer >> (N < 8 ? N*(N-1) : 0)) : 0);
+                    }
+                    data[0] = layer;
+                    data[1] = layer >> 8;
+                } else if (direction < 0) {
+                    memcpy(edge, data, BYTES_PER_ROW);
+                    memmove(data, data + BYTES_PER_ROW, LAYER_BYTES - BYTES_PER_ROW);
+                    if (wrap) {
+                        memcpy(data + LAYER_BYTES - BYTES_PER_ROW, edge, BYTES_PER_ROW);
+                    } else {
+                        memset(data + LAYER_BYTES - BYTES_PER_ROW, 0x00, BYTES_PER_ROW);
+                    }
+                } else {
+                    memcpy(edge, data + LAYER_BYTES - BYTES_PER_ROW, BYTES_PER_ROW);
+                    memmove(data + BYTES_PER_ROW, data, LAYER_BYTES - BYTES_PER_ROW);
+                    if (wrap) {
+                        memcpy(data, edge, BYTES_PER_ROW);
+                    } else {
+                        memset(data, 0x00, BYTES_PER_ROW);
+                    }
+                }
+            }
+        }
+        else if (axis == AXIS_X && N <= 8)
+        {
+            // one shift per byte, the masks keep the voxels inside their row and
+            // the voxels moving out come back in if wrap is set
+            data = frame[0];
+            if (direction < 0) {
+                for (i = 0; i < FRAME_BYTES; ++i, ++data) {
+                    *data = ((*data >> 1) & (ROW_REPEAT * (FULL_ROW >> 1))) |
+                            ((*data << (N-1)) & carry & (ROW_REPEAT << (N-1)));
+                }
+            } else {
+                for (i = 0; i < FRAME_BYTES; ++i, ++data) {
+                    *data = ((*data << 1) & (ROW_REPEAT * (FULL_ROW & (FULL_ROW << 1)))) |
+                            ((*data >> (N-1)) & carry & ROW_REPEAT);
+                }
+            }
+        }
+        else if (axis == AXIS_X)
+        {
+            // one shift per row
+            for (z = 0; z < N; ++z) {
+                for (i = 0; i < N; ++i) {
+                    Row row = getRow(frame, i, z);
+                    if (direction < 0) {
+                        row = (row >> 1) | ((Row)(row << (N-1)) & (wrap ? FULL_ROW : 0));
+                    } else {
+                        row = (Row)(row << 1) | ((row >> (N-1)) & (wrap ? FULL_ROW : 0));
+                    }
+                    setRow(frame, i, z, row);
+                }
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Transforms
+    // -----------------------------------------------------------------------------------
+    // All transforms work in place. Besides a few registers they only need one layer
+    // (N*N/8 bytes) on the stack, no second frame.
+
+    // Transposes an 8x8 bit matrix in place: 8 rows, stride bytes apart, bit x of row y
+    // becomes bit y of row x. Three rounds of delta swaps exchange the 4x4, 2x2 and 1x1
+    // blocks above the diagonal with the ones below it (12 swaps in total).
+    static void transposeBlock(uint8_t *rows, uint8_t stride)
+    {
+        uint8_t j;
+        uint8_t k;
+        uint8_t mask = 0x0F;
+        uint8_t t;
+
+        // mask: 0x0F, 0x33, 0x55; k runs over the rows with bit j clear
+        for (j = 4; j != 0; j >>= 1, mask ^= mask << j) {
+            for (k = 0; k < 8; k = (k + j + 1) & ~j) {
+                uint8_t *a = rows + k*stride;
+                uint8_t *b = rows + (k+j)*stride;
+                t = ((*a >> j) ^ *b) & mask;
+                *b ^= t;
+                *a ^= t << j;
+            }
+        }
+    }
+
+    // Transposes a layer in place: voxel (x,y) moves to (y,x)
+    static void transposeLayer(uint8_t *layer)
+    {
+        if (N < 8) {
+            // 4x4 bits in a 16 bit value (bit x + 4*y), two delta swaps
+            uint16_t value = layer[0] | (layer[1] << 8);
+            uint16_t t;
+            t = ((value >> 6) ^ value) & 0x00CC;
+            value ^= t ^ (t << 6);
+            t = ((value >> 3) ^ value) & 0x0A0A;
+            value ^= t ^ (t << 3);
+            layer[0] = value;
+            layer[1] = value >> 8;
+        } else if (N == 8) {
+            transposeBlock(layer, 1);
+        } else {
+            // transpose the four 8x8 blocks, then swap the two off the diagonal
+            uint8_t i;
+            transposeBlock(layer, BYTES_PER_ROW);
+            transposeBlock(layer + 1, BYTES_PER_ROW);
+            transposeBlock(layer + 8*BYTES_PER_ROW, BYTES_PER_ROW);
+            transposeBlock(layer + 8*BYTES_PER_ROW + 1, BYTES_PER_ROW);
+            for (i = 0; i < 8; ++i) {
+                uint8_t t = layer[i*BYTES_PER_ROW + 1];
+                layer[i*BYTES_PER_ROW + 1] = layer[(i+8)*BYTES_PER_ROW];
+                layer[(i+8)*BYTES_PER_ROW] = t;
+            }
+        }
+    }
+
+    // Reverses the voxels of every row in a byte (mirror along X)
+    static inline uint8_t mirrorByte(uint8_t value)
+    {
+        value = bitswap(value);
+        if (N < 8) {
+            // bitswap() also swapped the two rows of the byte
+            value = (value >> 4) | (value << 4);
+        }
+        return value;
+    }
+
+    // Swaps the two axes perpendicular to the given axis:
+    //   AXIS_Z: (x,y,z) -> (y,x,z), AXIS_X: (x,y,z) -> (x,z,y), AXIS_Y: (x,y,z) -> (z,y,x)
+    static void transpose(Layer *frame, uint8_t axis)
+    {
+        Layer matrix = {};
+        uint8_t i;
+        uint8_t j;
+
+        if (axis == AXIS_Z) {
+            for (i = 0; i < N; ++i) {
+                transposeLayer(frame[i]);
+            }
+        } else if (axis == AXIS_X) {
+            // rows only change places: row (y,z) <-> row (z,y)
+            for (i = 1; i < N; ++i) {
+                for (j = 0; j < i; ++j) {
+                    Row row = getRow(frame, j, i);
+                    setRow(frame, j, i, getRow(frame, i, j));
+                    setRow(frame, i, j, row);
+                }
+            }
+        } else if (axis == AXIS_Y) {
+            // the rows of all layers with the same y form a X/Z matrix
+            for (i = 0; i < N; ++i) {
+                for (j = 0; j < N; ++j) {
+                    setRow(&matrix, j, 0, getRow(frame, i, j));
+                }
+                transposeLayer(matrix);
+                for (j = 0; j < N; ++j) {
+                    setRow(frame, i, j, getRow(&matrix, j, 0));
+                }
+            }
+        }
+    }
+
+    // Mirrors the content along an axis: voxel n moves to N-1-n
+    static void mirror(Layer *frame, uint8_t axis)
+    {
+        uint8_t *data = frame[0];
+        uint8_t t;
+        uint8_t i;
+        uint16_t k;
+
+        if (axis == AXIS_X) {
+            if (N <= 8) {
+                for (k = 0; k < FRAME_BYTES; ++k) {
+                    data[k] = mirrorByte(data[k]);
+                }
+            } else {
+                for (k = 0; k < FRAME_BYTES; k += 2) {
+                    t = data[k];
+                    data[k] = mirrorByte(data[k+1]);
+                    data[k+1] = mirrorByte(t);
+                }
+            }
+        } else if (axis == AXIS_Y) {
+            for (k = 0; k < N; ++k) {
+                for (i = 0; i < N/2; ++i) {
+                    Row row = getRow(frame, i, k);
+                    setRow(frame, i, k, getRow(frame, N-1-i, k));
+                    setRow(frame, N-1-i, k, row);
+                }
+            }
+        } else if (axis == AXIS_Z) {
+            for (i = 0; i < N/2; ++i) {
+                for (k = 0; k < LAYER_BYTES; ++k) {
+                    t = frame[i][k];
+                    frame[i][k] = frame[N-1-i][k];
+                    frame[N-1-i][k] = t;
+                }
+            }
+        }
+    }
+
+    // Turns the content by 90 degrees around an axis. Direction 1 turns counterclockwise
+    // when looking from the positive end of the axis (X -> Y, Y -> Z, Z -> X), -1 the
+    // other way round. It's a transpose followed by a mirror.
+    static void rotate90(Layer *frame, uint8_t axis, int8_t direction)
+    {
+        // first and second axis of the plane, in right-handed order
+        uint8_t first = axis == AXIS_Z ? AXIS_X : (axis == AXIS_X ? AXIS_Y : AXIS_Z);
+        uint8_t second = axis == AXIS_Z ? AXIS_Y : (axis == AXIS_X ? AXIS_Z : AXIS_X);
+
+        transpose(frame, axis);
+        mirror(frame, direction > 0 ? first : second);
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Sprites
+    // -----------------------------------------------------------------------------------
+
+    // Moves a row of a sprite to position x, the voxels outside the cube are cut off
+    static inline Row placeRow(Wide row, int8_t x)
+    {
+        if (x < 0) {
+            return row >> -x;
+        }
+        return (row << x) & FULL_ROW;
+    }
+
+    // Combines a sprite at position (x,y,z) with the frame (See blit() in draw.h).
+    // Rows outside the cube are skipped, every other row takes one shift and one
+    // operation on the row of the frame.
+    static void blit(Layer *frame, const Sprite *sprite, int8_t x, int8_t y, int8_t z,
+                     uint8_t op)
+    {
+        uint8_t rowBytes = SPRITE_ROW_BYTES(sprite->sizeX);
+        uint8_t sy, sz;
+        uint8_t y1, y2, z1, z2;         // rows of the sprite inside the cube
+        const uint8_t *data;
+        Wide voxels = ((Wide)1 << sprite->sizeX) - 1;  // bits of a sprite row in use
+        Row extent;
+        Row row;
+
+        if (sprite->sizeX > N || sprite->sizeY > N || sprite->sizeZ > N ||
+            x <= -sprite->sizeX || x >= N || y <= -sprite->sizeY || y >= N ||
+            z <= -sprite->sizeZ || z >= N) {
+            return;
+        }
+        y1 = y < 0 ? -y : 0;
+        z1 = z < 0 ? -z : 0;
+        y2 = y + sprite->sizeY > N ? N - y : sprite->sizeY;
+        z2 = z + sprite->sizeZ > N ? N - z : sprite->sizeZ;
+        extent = placeRow(voxels, x);
+
+        for (sz = z1; sz < z2; ++sz) {
+            data = sprite->data + (sz*sprite->sizeY + y1)*rowBytes;
+            for (sy = y1; sy < y2; ++sy, data += rowBytes) {
+                row = placeRow((rowBytes > 1 ? data[0] | (data[1] << 8) : data[0]) & voxels, x);
+                switch (op) {
+                case BLIT_OR:
+                    orRow(frame, y+sy, z+sz, row);
+                    break;
+                case BLIT_AND:
+                    clrRow(frame, y+sy, z+sz, extent & ~row);
+                    break;
+                case BLIT_XOR:
+                    xorRow(frame, y+sy, z+sz, row);
+                    break;
+                case BLIT_MASK:
+                    clrRow(frame, y+sy, z+sz, row);
+                    break;
+                }
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------
+    // Cellular automaton
+    // -----------------------------------------------------------------------------------
+    // The neighbours are counted bit-sliced: a counter consists of several rows, row i
+    // holds bit i of the counters of all the voxels in a row. Every adder step counts
+    // a whole row at once.
+
+    // sum += value, sum has sumBits bits, value valueBits (carries beyond sum are lost)
+    static inline void addCounters(Row *sum, uint8_t sumBits, const Row *value, uint8_t valueBits)
+    {
+        Row carry = 0;
+        Row v;
+        Row s;
+        uint8_t i;
+
+        for (i = 0; i < sumBits; ++i) {
+            v = i < valueBits ? value[i] : 0;
+            s = sum[i] ^ v;
+            v &= sum[i];
+            sum[i] = s ^ carry;
+            carry = v | (carry & s);
+        }
+    }
+
+    // Voxels whose counter of the given bits is at least value. Going from the lowest bit
+    // upwards, a counter bit above the value bit decides for it, one below against it.
+    static inline Row atLeast(const Row *count, uint8_t bits, uint8_t value)
+    {
+        Row result = FULL_ROW;
+        uint8_t i;
+
+        for (i = 0; i < bits; ++i, value >>= 1) {
+            result = (value & 1) ? (count[i] & result) : (count[i] | result);
+        }
+        return value ? 0 : result;
+    }
+
+    // Number of living voxels at x-1, x and x+1 of a row (2 bits)
+    static inline void rowCounters(Row row, Row *count)
+    {
+        Row left = (row << 1) & FULL_ROW;       // voxel x-1 moved to x
+        Row right = row >> 1;                   // voxel x+1 moved to x
+
+        count[0] = left ^ row ^ right;
+        count[1] = (left & row) | (right & (left ^ row));
+    }
+
+    // Number of living voxels in the 3x3 square around (x,y) in layer z (4 bits)
+    static inline void squareCounters(const Layer *frame, uint8_t y, uint8_t z, Row *count)
+    {
+        Row rowCount[2];
+        uint8_t row;
+
+        count[0] = count[1] = count[2] = count[3] = 0;
+        for (row = y ? y - 1 : 0; row <= y + 1 && row < N; ++row) {
+            rowCounters(getRow(frame, row, z), rowCount);
+            addCounters(count, 4, rowCount, 2);
+        }
+    }
+
+    // One generation of a 3D life: frame gets the successor of previous (both must not be
+    // the same). A living voxel survives with surviveMin..surviveMax living neighbours
+    // (of 26), a dead one comes alive with birthMin..birthMax. Outside of the cube all
+    // voxels are dead.
+    // The counters of the squares in the layers below, at and above a voxel are added up
+    // to the number of living voxels in its 3x3x3 cube (the voxel included, 5 bits).
+    // Going upwards, every square counter is computed once.
+    static void lifeGeneration(Layer *frame, const Layer *previous, uint8_t surviveMin,
+                               uint8_t surviveMax, uint8_t birthMin, uint8_t birthMax)
+    {
+        Row below[4];
+        Row at[4];
+        Row above[4];
+        Row total[5];
+        Row self;
+        Row survives;
+        Row born;
+        uint8_t y;
+        uint8_t z;
+
+        for (y = 0; y < N; ++y) {
+            memset(below, 0, sizeof(below));
+            squareCounters(previous, y, 0, at);
+            for (z = 0; z < N; ++z) {
+                if (z + 1 < N) {
+                    squareCounters(previous, y, z + 1, above);
+                } else {
+                    memset(above, 0, sizeof(above));
+                }
+                memcpy(total, at, sizeof(at));
+                total[4] = 0;
+                addCounters(total, 5, below, 4);
+                addCounters(total, 5, above, 4);
+
+                // the total includes a living voxel itself
+                self = getRow(previous, y, z);
+                survives = atLeast(total, 5, surviveMin + 1) & ~atLeast(total, 5, surviveMax + 2);
+                born = atLeast(total, 5, birthMin) & ~atLeast(total, 5, birthMax + 1);
+                setRow(frame, y, z, ((self & survives) | (~self & born)) & FULL_ROW);
+
+                memcpy(below, at, sizeof(at));
+                memcpy(at, above, sizeof(above));
+            }
+        }
+    }
+};
+
+#endif
@@ -4,51 +4,75 @@
  * Email:   sandro.lutz@temparus.ch
  */
 
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+#include "global.h"
 #include "draw.h"
+#include "cube.h"
+#include "random.h"
+
+// Drawing code of this cube size
+typedef Cube<LAYER_COUNT> LEDcube;
+
+static_assert(LEDcube::LAYER_BYTES == LAYER_SIZE, "LAYER_SIZE doesn't match the cube layout");
+
+// cube state buffers, every frame consists of BAM_BITS bitplanes (most significant first)
+// Layout of a bitplane: [z][row bytes] (See cube.h)
+uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][LAYER_SIZE];
+bool grayBuffer[CUBE_BUFFER_COUNT];             // false: only plane 0 is used (on/off frame)
+uint8_t (*cube)[LAYER_SIZE] = cubeBuffer[0][0]; // plane 0 of the back buffer, all drawing goes here
+volatile uint8_t frontBuffer = 1;               // shown by the ISR
+volatile uint8_t pendingBuffer = NO_BUFFER;     // presented, the ISR shows it from the next refresh on
+volatile uint16_t pendingDue;                   // ... but not before this refresh
+volatile uint16_t refreshClock;
+uint8_t backBuffer = 0;
+uint8_t presentedBuffer = 1;                    // last presented frame (pending or front)
+volatile uint8_t displayLevel = MAX_LEVEL;      // level of on/off frames (global brightness)
+
+#ifdef RENDER_OUTPUT
+// PORTD value for every shift register clock, [buffer][plane][z][clock] (See draw.h)
+uint8_t outputBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][OUTPUT_SIZE];
+#endif
+
+// Lowest 8 bit intensity for each level (gamma 2.2), See gammaLevel()
+const uint8_t gammaThresholds[MAX_LEVEL] PROGMEM = {
+#if BAM_BITS == 4
+    54, 90, 113, 132, 148, 162, 174, 186, 197, 207, 217, 226, 235, 243, 251
+#else
+#error "Please add gamma thresholds for this BAM_BITS"
+#endif
+};
 
-#ifdef ARDUINO_X4
-#define LAYER_COUNT 4
-extern uint8_t cube[4][2];              // LAYER2__LAYER1
-#elif ARDUINO_X8
-#define LAYER_COUNT 8
-extern uint8_t cube[8][8];              // [z][y][x]
+// Level for every brightness setting, steps of the former refresh skipping (n+1)/11
+const uint8_t brightnessLevels[MAX_BRIGHTNESS+1] PROGMEM = {
+#if BAM_BITS == 4 && MAX_BRIGHTNESS == 10
+    1, 3, 4, 5, 7, 8, 10, 11, 12, 14, 15
 #else
-#error "Please specify cube size in Arduino configuration"
+#error "Please add brightness levels for this BAM_BITS and MAX_BRIGHTNESS"
 #endif
+};
 
 // ---------------------------------------------------------------------------------------
 // Draw functions for LEDcube
 // ---------------------------------------------------------------------------------------
+// All drawing goes into plane 0 of the back buffer, the code itself is in cube.h.
 
 // This function checks if the coordinate is valid
-// Because using uint8_t, only the upper limit needs to be checked.
 bool inRange(uint8_t x, uint8_t y, uint8_t z)
 {
-    return x < LAYER_COUNT && y < LAYER_COUNT && z < LAYER_COUNT;
+    return LEDcube::inRange(x,y,z);
 }
 
 // Turn on a single voxel
 void setVoxel(uint8_t x, uint8_t y, uint8_t z)
 {
-    if (inRange(x,y,z)) {
-#ifdef ARDUINO_X4
-        cube[z][y/2] |= (1<<(x+(y%2)*4));
-#elif ARDUINO_X8
-        cube[z][y] |= (1<<x);
-#endif
-    }
+    LEDcube::setVoxel(cube, x,y,z);
 }
 
 // Turn off a single voxel
 void clrVoxel(uint8_t x, uint8_t y, uint8_t z)
 {
-    if (inRange(x,y,z)) {
-#ifdef ARDUINO_X4
-        cube[z][y/2] &= ~(1<<(x+(y%2)*4));
-#elif ARDUINO_X8
-        cube[z][y] &= ~(1<<x);
-#endif
-    }
+    LEDcube::clrVoxel(cube, x,y,z);
 }
 
 // Alter a single voxel base on the the state
@@ -64,32 +88,13 @@ void alterVoxel(uint8_t x, uint8_t y, uint8_t z, uint8_t state)
 // Toggle a single voxel
 void toggleVoxel(uint8_t x, uint8_t y, uint8_t z)
 {
-    if (inRange(x,y,z)) {
-#ifdef ARDUINO_X4
-        cube[z][y/2] ^= (1<<(x+(y%2)*4));
-#elif ARDUINO_X8
-        cube[z][y] ^= (1 << x);
-#endif
-    }
+    LEDcube::toggleVoxel(cube, x,y,z);
 }
 
 // Get the current status of a voxel
 uint8_t getVoxel(uint8_t x, uint8_t y, uint8_t z)
 {
-    if (inRange(x,y,z)) {
-#ifdef ARDUINO_X4
-        if (cube[z][y/2] & (1<<(x+(y%2)*4))) {
-            return 0x01;
-        }
-        return 0x00;
-#elif ARDUINO_X8
-        if (cube[z][y] & (1<<x)) {
-            return 0x01;
-        }
-        return 0x00;
-#endif
-    }
-    return 0x00;
+    return LEDcube::getVoxel(cube, x,y,z);
 }
 
 // Fill the whole buffer with a pattern
@@ -97,303 +102,296 @@ uint8_t getVoxel(uint8_t x, uint8_t y, uint8_t z)
 //          fill(0xff) -> fill all
 void fill(uint8_t pattern)
 {
-    uint8_t z;
-    uint8_t y;
-    for (z=0; z<LAYER_COUNT; ++z)
-    {
-#ifdef ARDUINO_X4
-        for (y=0; y<2; ++y)
-        {
-            cube[z][y] = pattern;
-        }
-#else
-        for (y=0; y<LAYER_COUNT; ++y)
-        {
-            cube[z][y] = pattern;
-        }
-#endif
-    }
+    grayBuffer[backBuffer] = false;
+    LEDcube::fill(cube, pattern);
 }
 
 // Set all voxels along a Y/Z plane at a given point on axis X
 void setPlaneX(uint8_t x)
 {
-    uint8_t z;
-    uint8_t y;
-    if (inRange(x,0,0))
-    {
-        for (z=0; z<LAYER_COUNT; ++z)
-        {
-#ifdef ARDUINO_X4
-            for (y=0; y<2; ++y)
-            {
-                cube[z][y] |= (1 << x) | (1 << (x+4));
-            }
-#else
-            for (y=0; y<LAYER_COUNT; ++y)
-            {
-                cube[z][y] |= (1 << x);
-            }
-#endif
-        }
-    }
+    LEDcube::setPlaneX(cube, x);
 }
 
 // Clear voxels in the same manner as above
 void clrPlaneX(uint8_t x)
 {
-    uint8_t z;
-    uint8_t y;
-    if (inRange(x,0,0))
-    {
-        for (z=0; z<LAYER_COUNT; ++z)
-        {
-#ifdef ARDUINO_X4
-            for (y=0; y<2; ++y)
-            {
-                cube[z][y] &= ~((1 << x) | (1 << (x+4)));
-            }
-#else
-            for (y=0; y<LAYER_COUNT; ++y)
-            {
-                cube[z][y] &= ~(1 << x);
-            }
-#endif
-        }
-    }
+    LEDcube::clrPlaneX(cube, x);
 }
 
 // Set all voxels along a X/Z plane at a given point on axis Y
 void setPlaneY(uint8_t y)
 {
-    uint8_t z;
-    if (inRange(0,y,0))
-    {
-        for (z=0; z<LAYER_COUNT; ++z) {
-#ifdef ARDUINO_X4
-            cube[z][y/2] |= (15<<((y%2)*4));
-#else
-            cube[z][y] = 0xFF;
-#endif
-        }
-    }
+    LEDcube::setPlaneY(cube, y);
 }
 
 // Clear voxels in the same manner as above
 void clrPlaneY(uint8_t y)
 {
-    uint8_t z;
-    if (inRange(0,y,0))
-    {
-        for (z=0; z<LAYER_COUNT; ++z)
-#ifdef ARDUINO_X4
-            cube[z][y/2] &= ~(15<<((y%2)*4));
-#else
-                cube[z][y] = 0x00;
-#endif
-    }
+    LEDcube::clrPlaneY(cube, y);
 }
 
 // Set all voxels along a X/Y plane at a given point on axis Z
 void setPlaneZ(uint8_t z)
 {
-    uint8_t i;
-    if (inRange(0,0,z))
-    {
-        for (i=0; i<LAYER_COUNT; ++i) {
-            cube[z][i] = 0xff;
-        }
-    }
+    LEDcube::setPlaneZ(cube, z);
 }
 
 // Clear voxels in the same manner as above
 void clrPlaneZ(uint8_t z)
+{
+    LEDcube::clrPlaneZ(cube, z);
+}
+
+// Replace the X/Y plane at z by random voxels, 16 of them per mask
+void randomSparseLayer(uint8_t z, uint8_t density)
 {
     uint8_t i;
-    if (inRange(0,0,z))
-    {
-        for (i=0; i<LAYER_COUNT; ++i)
-            cube[z][i] = 0x00;
+    uint16_t mask;
+
+    for (i = 0; i < LAYER_SIZE; i += 2) {
+        mask = randomMask(density);
+        cube[z][i] = mask;
+        cube[z][i+1] = mask >> 8;
     }
 }
 
 // Draw a box
-// Type: BOX_FILLED Draws a box with all walls drawn and all voxels inside set
-//       BOX_WALLS  Draws a box with all walls drawn. The state of all voxels inside won't be changed.
-//       BOX_FRAME  This only draws the corners and edges. No walls will be drawn.
 void box(uint8_t type, uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2)
 {
-    uint8_t i;
-    uint8_t j;
-
-    if (inRange(x1,y1,z1) && inRange(x2,y2,z2)) {
-        orderValues(&x1, &x2);
-        orderValues(&y1, &y2);
-        orderValues(&z1, &z2);
-
-        if (type == BOX_FILLED)
-        {
-            for (i = z1; i <= z2; ++i) {
-                for (j = y1; j <= y2; ++j) {
-#ifdef ARDUINO_X4
-                    cube[i][j/2] |= (byteline(x1, x2)<<((j%2)*4));
-#else
-                    cube[i][j] |= byteline(x1, x2);
-#endif
-                }
-            }
-        }
-        else if (type == BOX_WALLS)
-        {
-            for (i = z1; i <= z2; ++i) {
-                for (j = y1; j <= y2; ++j) {
-                    if (j == y1 || j == y2 || i == z1 || i == z2) {
-#ifdef ARDUINO_X4
-                        cube[i][j/2] = (byteline(x1, x2)<<((j%2*4)));
-#else
-                        cube[i][j] = byteline(x1, x2);
-#endif
-                    } else {
-#ifdef ARDUINO_X4
-                        cube[i][j/2] |= (1 << (x1+(j%2)*4)) | (1 << (x2+(j%2)*4));
-#else
-                        cube[i][j] |= (1 << x1) | (1 << x2);
-#endif
-                    }
-                }
-            }
-        }
-        else if (type == BOX_FRAME)
-        {
-            // Lines along X axis
-#ifdef ARDUINO_X4
-            cube[z1][y1/2] = (byteline(x1, x2) << ((y1%2)*4));
-            cube[z1][y2/2] = (byteline(x1, x2) << ((y2%2)*4));
-            cube[z2][y1/2] = (byteline(x1, x2) << ((y1%2)*4));
-            cube[z2][y2/2] = (byteline(x1, x2) << ((y2%2)*4));
-#else
-            cube[z1][y1] = byteline(x1, x2);
-            cube[z1][y2] = byteline(x1, x2);
-            cube[z2][y1] = byteline(x1, x2);
-            cube[z2][y2] = byteline(x1, x2);
-#endif
+    LEDcube::box(cube, type, x1, y1, z1, x2, y2, z2);
+}
 
-            // Lines along Y axis
-            for (j = y1; j <= y2; ++j) {
-                setVoxel(x1, j, z1);
-                setVoxel(x1, j, z2);
-                setVoxel(x2, j, z1);
-                setVoxel(x2, j, z2);
-            }
+// Draws a line between two coordinates in 3D space
+void line(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2)
+{
+    LEDcube::line(cube, x1, y1, z1, x2, y2, z2);
+}
 
-            // Lines along Z axis
-            for (i = z1; i <= z2; ++i) {
-                setVoxel(x1, y1, i);
-                setVoxel(x1, y2, i);
-                setVoxel(x2, y1, i);
-                setVoxel(x2, y2, i);
-            }
+// Shift the entire content of the cube along an axis
+void shift(uint8_t axis, int8_t direction)
+{
+    LEDcube::moveContent(cube, axis, direction, false);
+}
+
+// Rotate the entire content of the cube along an axis (wrap around)
+void rotate(uint8_t axis, int8_t direction)
+{
+    LEDcube::moveContent(cube, axis, direction, true);
+}
+
+// Turn the content by 90 degrees around an axis
+void rotate90(uint8_t axis, int8_t direction)
+{
+    LEDcube::rotate90(cube, axis, direction);
+}
+
+// Mirror the content along an axis
+void mirror(uint8_t axis)
+{
+    LEDcube::mirror(cube, axis);
+}
+
+// Swap the two axes perpendicular to the given axis
+void transpose(uint8_t axis)
+{
+    LEDcube::transpose(cube, axis);
+}
+
+// Advance the content by one generation of a 3D life
+void lifeGeneration(uint8_t surviveMin, uint8_t surviveMax, uint8_t birthMin, uint8_t birthMax)
+{
+    uint8_t previous[LAYER_COUNT][LAYER_SIZE];
+
+    memcpy(previous, cube, sizeof(previous));
+    LEDcube::lifeGeneration(cube, previous, surviveMin, surviveMax, birthMin, birthMax);
+}
+
+// CRC16 of the content
+uint16_t frameHash()
+{
+    const uint8_t *data = cube[0];
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+
+    for (i = 0; i < FRAME_SIZE; ++i) {
+        crc = _crc16_update(crc, data[i]);
+    }
+    return crc;
+}
+
+// Combine a sprite with the content of the cube
+void blit(const Sprite *sprite, int8_t x, int8_t y, int8_t z, uint8_t op)
+{
+    LEDcube::blit(cube, sprite, x, y, z, op);
+}
+
+// ---------------------------------------------------------------------------------------
+// Grayscale
+// ---------------------------------------------------------------------------------------
+
+// Switch the back buffer to grayscale. Voxels which are on get the full level.
+static void beginGray()
+{
+    uint8_t plane;
+
+    if (!grayBuffer[backBuffer]) {
+        for (plane = 1; plane < BAM_BITS; ++plane) {
+            memcpy(cubeBuffer[backBuffer][plane], cube, LAYER_COUNT*LAYER_SIZE);
         }
+        grayBuffer[backBuffer] = true;
     }
+}
 
+// Position of a voxel in a bitplane: byte offset and bit mask (no range check)
+static inline uint16_t voxelOffset(uint8_t x, uint8_t y, uint8_t z)
+{
+    return z*LAYER_SIZE + LEDcube::voxelIndex(x, y);
 }
 
-// Draws a line between two coordinates in 3D space
-void line(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2)
+// Set the level of a single voxel
+void setVoxelLevel(uint8_t x, uint8_t y, uint8_t z, uint8_t level)
 {
-    // TODO: optimize this function (without using float!)
-    float xy;       // how many voxels do we move on the y axis for each step on the x axis
-    float xz;       // how many voxels do we move on the y axis for each step on the x axis
-    uint8_t x,y,z;
-
-    // We always want to draw the line from x=0 to x=7.
-    // If x1 is bigget than x2, we need to flip all the values.
-    if (x1 > x2) {
-        int tmp;
-        tmp = x2;
-        x2 = x1;
-        x1 = tmp;
-        tmp = y2;
-        y2 = y1;
-        y1 = tmp;
-        tmp = z2;
-        z2 = z1;
-        z1 = tmp;
+    uint8_t plane;
+    uint16_t offset;
+    uint8_t mask;
+
+    if (inRange(x,y,z)) {
+        beginGray();
+        offset = voxelOffset(x, y, z);
+        mask = LEDcube::voxelMask(x, y);
+        for (plane = 0; plane < BAM_BITS; ++plane) {
+            uint8_t *row = &cubeBuffer[backBuffer][plane][0][offset];
+            if (level & (1<<(BAM_BITS-1-plane))) {
+                *row |= mask;
+            } else {
+                *row &= ~mask;
+            }
+        }
     }
+}
 
-    if (y1 > y2) {
-        xy = (float) (y1 - y2) / (float) (x2 - x1);
-    } else {
-        xy = (float) (y2 - y1) / (float) (x2 - x1);
+// Get the level of a single voxel
+uint8_t getVoxelLevel(uint8_t x, uint8_t y, uint8_t z)
+{
+    uint8_t plane;
+    uint16_t offset;
+    uint8_t mask;
+    uint8_t level = 0;
+
+    if (inRange(x,y,z)) {
+        if (!grayBuffer[backBuffer]) {
+            return getVoxel(x,y,z) ? MAX_LEVEL : 0;
+        }
+        offset = voxelOffset(x, y, z);
+        mask = LEDcube::voxelMask(x, y);
+        for (plane = 0; plane < BAM_BITS; ++plane) {
+            level = (level << 1) | ((cubeBuffer[backBuffer][plane][0][offset] & mask) ? 1 : 0);
+        }
     }
+    return level;
+}
 
-    if (z1 > z2) {
-        xz = (float) (z1 - z2) / (float) (x2 - x1);
-    } else {
-        xz = (float) (z2 - z1) / (float) (x2 - x1);
+// Fill the whole buffer with a level
+void fillLevel(uint8_t level)
+{
+    uint8_t plane;
+
+    for (plane = 0; plane < BAM_BITS; ++plane) {
+        memset(cubeBuffer[backBuffer][plane], (level & (1<<(BAM_BITS-1-plane))) ? 0xFF : 0x00,
+               LAYER_COUNT*LAYER_SIZE);
     }
+    grayBuffer[backBuffer] = true;
+}
+
+// Converts an 8 bit intensity to a level, corrected for the eye's response (gamma 2.2)
+uint8_t gammaLevel(uint8_t intensity)
+{
+    uint8_t level = 0;
 
-    // For each step of x, y increments by:
-    for (x = x1; x <= x2; ++x) {
-        y = (xy * (x - x1)) + y1;
-        z = (xz * (x - x1)) + z1;
-        setVoxel(x, y, z);
+    while (level < MAX_LEVEL && intensity >= pgm_read_byte(&gammaThresholds[level])) {
+        ++level;
     }
+    return level;
 }
 
-// Shift the entire content of the cube along an axis
-void shift(uint8_t axis, int8_t direction)
+// Set the global brightness (0..MAX_BRIGHTNESS) of on/off frames
+void setBrightness(uint8_t brightness)
 {
-    uint8_t i, j ,k;
-    uint8_t current_pos, previous_pos;
-    uint8_t state = 0x00;
-    uint8_t tmp;
+    if (brightness > MAX_BRIGHTNESS) {
+        brightness = MAX_BRIGHTNESS;
+    }
+    displayLevel = pgm_read_byte(&brightnessLevels[brightness]);
+}
 
-    for (i = 0; i < LAYER_COUNT-1; ++i)
-    {
-        if (direction == -1) {
-            current_pos = i;
-        } else {
-            current_pos = (7-i);
-        }
+// ---------------------------------------------------------------------------------------
+// Frame buffer
+// ---------------------------------------------------------------------------------------
 
-        for (j = 0; j < LAYER_COUNT; ++j)
-        {
-            for (k = 0; k < LAYER_COUNT; ++k)
-            {
-                if (direction == -1) {
-                    previous_pos = current_pos+1;
-                } else {
-                    previous_pos = current_pos-1;
-                }
-
-                if (axis == AXIS_Z) {
-                    state = getVoxel(j,k,previous_pos);
-                    alterVoxel(j,k,current_pos,state);
-                } else if (axis == AXIS_Y) {
-                    state = getVoxel(j,previous_pos,k);
-                    alterVoxel(j,current_pos,k,state);
-                } else if (axis == AXIS_X) {
-                    state = getVoxel(previous_pos,k,j);
-                    alterVoxel(current_pos,k,j,state);
-                }
-            }
-        }
+#ifdef RENDER_OUTPUT
+// Convert the used planes of a buffer into the PORTD values the ISR shifts out:
+// bits 0/1 of a byte in the first clock, bits 6/7 in the last one
+static void renderOutput(uint8_t buffer)
+{
+    const uint8_t *source = cubeBuffer[buffer][0][0];
+    uint8_t *target = outputBuffer[buffer][0][0];
+    uint8_t count = (grayBuffer[buffer] ? BAM_BITS : 1) * LAYER_COUNT*LAYER_SIZE;
+
+    while (count--) {
+        uint8_t data = *source++;
+        *target++ = data << 6;
+        *target++ = (data << 4) & 0xC0;
+        *target++ = (data << 2) & 0xC0;
+        *target++ = data & 0xC0;
     }
+}
+#endif
+
+// Hand the back buffer over to the ISR and continue drawing in a free buffer.
+// The third buffer is the one which is neither shown nor presented. If the ISR didn't
+// pick up the previously presented frame yet, that frame is dropped and reused.
+static void handOver(bool keepContent, bool timed, uint16_t refresh)
+{
+    uint8_t oldSREG = SREG;
+    uint8_t presented = backBuffer;
 
-    if (direction == -1) {
-        current_pos = 7;
+#ifdef RENDER_OUTPUT
+    renderOutput(presented);
+#endif
+    cli();
+    pendingDue = timed ? refresh : refreshClock;
+    pendingBuffer = presented;
+    backBuffer = 3 - frontBuffer - presented;
+    SREG = oldSREG;
+
+    presentedBuffer = presented;
+    cube = cubeBuffer[backBuffer][0];
+    if (keepContent) {
+        revertFrame();
     } else {
-        current_pos = 0;
+        grayBuffer[backBuffer] = false;
     }
+}
 
-    if (axis == AXIS_X) {
-        clrPlaneX(current_pos);
-    } else if (axis == AXIS_Y) {
-        clrPlaneY(current_pos);
-    } else if(axis == AXIS_Z) {
-        clrPlaneZ(current_pos);
-    }
+// Show the back buffer from the next refresh on
+void present(bool keepContent)
+{
+    handOver(keepContent, false, 0);
+}
+
+// Show the back buffer from the given refresh on
+void presentAt(uint16_t refresh)
+{
+    handOver(false, true, refresh);
+}
+
+// Replace the content of the back buffer with the last presented frame
+void revertFrame()
+{
+    bool gray = grayBuffer[presentedBuffer];
+
+    memcpy(cubeBuffer[backBuffer], cubeBuffer[presentedBuffer],
+           (gray ? BAM_BITS : 1) * LAYER_COUNT*LAYER_SIZE);
+    grayBuffer[backBuffer] = gray;
 }
 
 // ---------------------------------------------------------------------------------------
@@ -424,6 +422,7 @@ uint8_t bitswap(uint8_t value)
 {
     uint8_t result;
 
+#ifdef __AVR__
     asm("mov __tmp_reg__, %[in] \n\t"
             "lsl __tmp_reg__  \n\t"   /* shift out high bit to carry */
             "ror %[out] \n\t"  /* rotate carry __tmp_reg__to low bit (eventually) */
@@ -443,5 +442,11 @@ uint8_t bitswap(uint8_t value)
             "lsl __tmp_reg__  \n\t"   /* 8 */
             "ror %[out] \n\t"
     : [out] "=r" (result) : [in] "r" (value));
+#else
+    result = 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        result = (result << 1) | ((value >> i) & 0x01);
+    }
+#endif
     return(result);
 }
@@ -13,6 +13,35 @@
 #define AXIS_Y 2
 #define AXIS_Z 3
 
+// Number of frame buffers: back (drawing), presented and front (shown)
+#define CUBE_BUFFER_COUNT 3
+
+// Bit-angle modulation: every frame has BAM_BITS bitplanes, plane p is shown for
+// 2^(BAM_BITS-1-p) time units. This gives levels 0..MAX_LEVEL per voxel.
+#ifndef BAM_BITS
+#define BAM_BITS 4
+#endif
+#define MAX_LEVEL ((1<<BAM_BITS)-1)
+
+// Global brightness setting (0..MAX_BRIGHTNESS)
+#define MAX_BRIGHTNESS 10
+
+// Shift register output of the display ISR
+#define OUTPUT_LOOP     0       // loop with nop delays around the clock edges
+#define OUTPUT_UNROLLED 1       // one out/sbi/cbi sequence per clock, no delays
+#ifndef OUTPUT_BACKEND
+#define OUTPUT_BACKEND OUTPUT_UNROLLED
+#endif
+
+// ARDUINO_X4 shifts two voxels of a row per clock (PD6: even x, PD7: odd x), the rows
+// one after the other. With the unrolled output, present() renders every frame into the
+// PORTD values of its OUTPUT_SIZE clocks per layer, so the ISR doesn't have to take the
+// bytes apart.
+#if defined(ARDUINO_X4) && OUTPUT_BACKEND == OUTPUT_UNROLLED
+#define RENDER_OUTPUT
+#define OUTPUT_SIZE 8
+#endif
+
 // defines box type
 #define BOX_FILLED 1
 #define BOX_WALLS  2
@@ -52,6 +81,10 @@ void clrPlaneY(uint8_t y);
 void setPlaneZ(uint8_t z);
 void clrPlaneZ(uint8_t z);
 
+// Replace the X/Y plane at z by random voxels, each set with a probability of density/256
+// (See randomMask() in random.h)
+void randomSparseLayer(uint8_t z, uint8_t density);
+
 // Draw a box
 // Type: BOX_FILLED Draws a box with all walls drawn and all voxels inside set
 //       BOX_WALLS  Draws a box with all walls drawn. The state of all voxels inside won't be changed.
@@ -59,11 +92,130 @@ void clrPlaneZ(uint8_t z);
 void box(uint8_t type, uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2);
 
 // Draws a line between two coordinates in 3D space
+// Both end points need to be inside the cube. Lines may run in any direction.
 void line(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2);
 
 // Shift the entire content of the cube along an axis
+// Direction: -1 towards 0, 1 away from 0. Voxels moving out of the cube are lost.
 void shift(uint8_t axis, int8_t direction);
 
+// Rotate the entire content of the cube along an axis
+// Same as shift(), but voxels moving out of the cube come back in on the other side.
+void rotate(uint8_t axis, int8_t direction);
+
+// Whole cube transforms, all of them in place (no second frame buffer needed).
+// ARDUINO_X8 uses 8x8 bit-matrix transposes and bitswap(), no per voxel copies.
+// Rough cycle counts on the AVR, estimated from the instructions (X4 / X8):
+//   transpose Z  250 / 3600     mirror X  300 / 2100
+//   transpose X  250 /  900     mirror Y  500 /  700
+//   transpose Y 1000 / 5000     mirror Z   60 /  500
+// rotate90() is a transpose followed by a mirror.
+
+// Turn the content by 90 degrees around an axis
+// Direction: 1 counterclockwise seen from the positive end of the axis, -1 clockwise
+void rotate90(uint8_t axis, int8_t direction);
+
+// Mirror the content along an axis (voxel n moves to LAYER_COUNT-1-n)
+void mirror(uint8_t axis);
+
+// Swap the two axes perpendicular to the given axis
+// Example: transpose(AXIS_Z) moves voxel (x,y,z) to (y,x,z)
+void transpose(uint8_t axis);
+
+// Advance the content by one generation of a 3D life: a voxel survives with surviveMin..
+// surviveMax of its 26 neighbours alive, an empty one comes alive with birthMin..birthMax.
+// The neighbours are counted bit-sliced, a whole row at once. Besides the copy of the
+// frame (64 bytes on ARDUINO_X8) it only needs a few counters on the stack.
+// Rough cycle count on the AVR, estimated from the instructions: X4 3500, X8 16000
+void lifeGeneration(uint8_t surviveMin, uint8_t surviveMax, uint8_t birthMin, uint8_t birthMax);
+
+// CRC16 (_crc16_update starting with 0xFFFF) of the content, e.g. to recognize a frame
+// which has been drawn before
+uint16_t frameHash();
+
+
+// ---------------------------------------------------------------------------------------
+// Sprites
+// ---------------------------------------------------------------------------------------
+// A sprite is a box of sizeX*sizeY*sizeZ voxels (at most LAYER_COUNT each way). data
+// holds its rows along X, layer (z) after layer and row (y) after row. Bit x of a row
+// is voxel x, a row takes SPRITE_ROW_BYTES(sizeX) bytes.
+
+#define SPRITE_ROW_BYTES(sizeX) (((sizeX) + 7) / 8)
+
+struct Sprite {
+    uint8_t sizeX;
+    uint8_t sizeY;
+    uint8_t sizeZ;
+    const uint8_t *data;
+};
+
+#define BLIT_OR   0             // turn on the voxels of the sprite
+#define BLIT_AND  1             // turn off the voxels in the box of the sprite which are off in it
+#define BLIT_XOR  2             // toggle the voxels of the sprite
+#define BLIT_MASK 3             // turn off the voxels of the sprite
+
+// Combine a sprite with the content of the cube, its voxel (0,0,0) at position (x,y,z)
+// Positions may be negative or beyond the cube, only the part inside the cube is drawn.
+// This allows to move objects into the cube and out of it again.
+void blit(const Sprite *sprite, int8_t x, int8_t y, int8_t z, uint8_t op);
+
+
+// ---------------------------------------------------------------------------------------
+// Grayscale
+// ---------------------------------------------------------------------------------------
+// The functions above only change plane 0, the most significant bit of the level.
+// A frame is either an on/off frame, shown with the global brightness, or a grayscale
+// frame. Drawing a level turns the frame into a grayscale frame (voxels which are on
+// get MAX_LEVEL), fill() turns it back into an on/off frame.
+
+// Set the level (0..MAX_LEVEL) of a single voxel
+void setVoxelLevel(uint8_t x, uint8_t y, uint8_t z, uint8_t level);
+// Get the level of a single voxel
+uint8_t getVoxelLevel(uint8_t x, uint8_t y, uint8_t z);
+// Fill the whole buffer with a level
+void fillLevel(uint8_t level);
+
+// Converts an 8 bit intensity to a level, corrected for the eye's response (gamma 2.2)
+uint8_t gammaLevel(uint8_t intensity);
+// Set the global brightness (0..MAX_BRIGHTNESS) of on/off frames
+void setBrightness(uint8_t brightness);
+
+// ---------------------------------------------------------------------------------------
+// Frame buffer
+// ---------------------------------------------------------------------------------------
+
+// All draw functions work on the back buffer. present() hands it over to the ISR, which
+// shows it from the start of the next refresh on (layer 0), so frames never tear.
+// keepContent: true  - continue drawing on a copy of the presented frame
+//              false - the new back buffer contains an old frame (use when redrawing everything)
+void present(bool keepContent);
+
+// Like present(false), but the frame isn't shown before the given refresh (refreshClock
+// value): the ISR switches to it exactly at the start of that refresh.
+void presentAt(uint16_t refresh);
+
+// Replace the content of the back buffer with the last presented frame
+void revertFrame();
+
+#define NO_BUFFER 0xFF
+
+extern volatile uint8_t frontBuffer;
+extern volatile uint8_t pendingBuffer;
+extern volatile uint16_t pendingDue;
+// Number of refreshes since the start (wraps after 55 s, See REFRESH_TICKS in LEDcube.ino)
+extern volatile uint16_t refreshClock;
+
+// Called by the ISR at the start of a refresh to pick up the presented frame
+// (inline, a function call would make the ISR save all registers)
+static inline void latchFrame()
+{
+    ++refreshClock;
+    if (pendingBuffer != NO_BUFFER && (int16_t)(refreshClock - pendingDue) >= 0) {
+        frontBuffer = pendingBuffer;
+        pendingBuffer = NO_BUFFER;
+    }
+}
 
 // ---------------------------------------------------------------------------------------
 // Helper functions
@@ -4,235 +4,528 @@
  * Email:   sandro.lutz@temparus.ch
  */
 
+#include <avr/pgmspace.h>
 #include "effects.h"
 #include "global.h"
-#include "utils.h"
 #include "draw.h"
+#include "scheduler.h"
+#include "animation.h"
+#include "random.h"
 
 #define NO_EFFECT_ACTIVE 0xFF
 
-uint8_t brightness = MAX_BRIGHTNESS;
+#define LIFE_DENSITY 64         // probability of a living voxel in a new seed [1/256]
+#define LIFE_HISTORY 8          // generations a new one is compared with
+
+// Probability of a new rain drop per voxel of the top layer [1/256], 1.5 drops per tick
+#define RAIN_DENSITY (384 / (LAYER_COUNT*LAYER_COUNT))
+
+// Result of an effect tick
+#define TICK_IDLE     0         // nothing has been drawn
+#define TICK_DRAWN    1         // a new frame has been drawn
+#define TICK_FINISHED 2         // the effect has been finished
+
+// ---------------------------------------------------------------------------------------
+// Effect states
+// ---------------------------------------------------------------------------------------
+// Only one effect runs at a time, so the states share their memory. startEffect()
+// clears the state before the init function of the effect is called.
+
+struct rainState {
+    uint8_t drained;            // layers shifted out since the effect should finish
+};
+
+struct toggleRandomState {
+};
+
+struct planeBounceState {
+    uint8_t axis;
+    uint8_t position;
+    uint8_t counter;            // walls reached on the current axis
+};
+
+typedef planeBounceState stickyPlaneBounceState;
+
+struct blinkState {
+    uint16_t delay;             // time between two flashes [ms]
+    uint8_t darkFrames;         // the same in frames, See blinkDelayChanged()
+    bool lit;
+    bool slowingDown;
+};
+
+struct animationState {
+    uint8_t duration;           // frames the current frame is shown
+};
+
+struct textState {
+    uint8_t mode;               // TEXT_SCROLL, TEXT_AROUND or TEXT_FLY
+    uint16_t step;
+};
+
+struct lifeState {
+    uint16_t history[LIFE_HISTORY];     // frame hashes of the last generations
+    uint8_t next;                       // oldest entry in history
+};
+
+#define EFFECT_STATE(name, interval) name##State name;
+union EffectState {
+    EFFECT_LIST(EFFECT_STATE)
+};
+#undef EFFECT_STATE
 
 uint8_t previousEffectIndex = NO_EFFECT_ACTIVE;
 uint8_t currentEffectIndex = NO_EFFECT_ACTIVE;
-uint16_t effectState[5];            // can be used by every effect
-unsigned long lastExecutionTime;
+EffectState effectState;
+uint16_t elapsedFrames;         // frames since the last drawn tick
 
-// Start a new effect.
-// NOTE: This will force finish the current effect!
-void startEffect(uint8_t index)
+// ---------------------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------------------
+
+// Set all voxels of a plane perpendicular to the axis
+static void setPlane(uint8_t axis, uint8_t position)
 {
-    if (index < EFFECTS_COUNT) {
-        currentEffectIndex = index;
+    if (axis == AXIS_Z) {
+        setPlaneZ(position);
+    } else if (axis == AXIS_Y) {
+        setPlaneY(position);
+    } else {
+        setPlaneX(position);
     }
-    fill(0x00);
-    brightness = MAX_BRIGHTNESS;
 }
 
-// Get current effect index
-uint8_t getCurrentEffect()
+// Clear all voxels of a plane perpendicular to the axis
+static void clrPlane(uint8_t axis, uint8_t position)
 {
-    return currentEffectIndex;
+    if (axis == AXIS_Z) {
+        clrPlaneZ(position);
+    } else if (axis == AXIS_Y) {
+        clrPlaneY(position);
+    } else {
+        clrPlaneX(position);
+    }
 }
 
-// Get previous effect index
-uint8_t getPreviousEffect()
+// Axis following the given one in the order Z, Y, X
+static uint8_t nextAxis(uint8_t axis)
 {
-    return previousEffectIndex;
+    if (axis == AXIS_Z) {
+        return AXIS_Y;
+    } else if (axis == AXIS_Y) {
+        return AXIS_X;
+    }
+    return AXIS_Z;
 }
 
-// Checks if the current effect has been finished
-bool isEffectFinished()
+// ---------------------------------------------------------------------------------------
+// Rain effect
+// ---------------------------------------------------------------------------------------
+
+// nothing to set up or clean up (See EffectDescriptor)
+#define rainInit   0
+#define rainFinish 0
+
+static uint8_t rainTick(uint16_t /* elapsed */, bool shouldFinish)
 {
-    return currentEffectIndex == NO_EFFECT_ACTIVE;
+    rainState *state = &effectState.rain;
+
+    shift(AXIS_Z, -1);
+    if (!shouldFinish) {
+        randomSparseLayer(LAYER_COUNT - 1, RAIN_DENSITY);
+    } else if (++state->drained == LAYER_COUNT) {
+        return TICK_FINISHED;
+    }
+    return TICK_DRAWN;
 }
 
-// Finish effect right now. This may look strange
-void forceFinishEffect()
+// ---------------------------------------------------------------------------------------
+// Toggle random voxels
+// ---------------------------------------------------------------------------------------
+
+#define toggleRandomInit   0
+#define toggleRandomFinish 0
+
+static uint8_t toggleRandomTick(uint16_t /* elapsed */, bool shouldFinish)
 {
-    fill(0x00);
-    memset(effectState, 0x00, 10);            // reset effect memory
-    previousEffectIndex = currentEffectIndex;
-    currentEffectIndex = NO_EFFECT_ACTIVE;
+    uint8_t random_number = randomCoordinate();
+    uint8_t x, y, z;
+
+    if (shouldFinish) {
+        return TICK_FINISHED;
+    }
+    while (random_number--) {
+        x = randomCoordinate();
+        y = randomCoordinate();
+        z = randomCoordinate();
+        toggleVoxel(x, y, z);
+    }
+    return TICK_DRAWN;
 }
 
-// Executes another cycle of the effect
-void processEffect(bool shouldFinish)
+// ---------------------------------------------------------------------------------------
+// Plane bounce: a plane moves back and forth twice, then the axis changes
+// ---------------------------------------------------------------------------------------
+
+static void planeBounceInit()
 {
-    unsigned long deltaTime = getTimeDifference(lastExecutionTime, millis());
+    effectState.planeBounce.axis = AXIS_Z;
+}
 
-    if (currentEffectIndex == 0)                    // rain effect
-    {
-        if (deltaTime >= 1000)
-        {
-            shift(AXIS_Z, -1);
-            if(!shouldFinish) {
-                uint8_t random_number = rand() % 4;
+static uint8_t planeBounceTick(uint16_t /* elapsed */, bool shouldFinish)
+{
+    planeBounceState *state = &effectState.planeBounce;
 
-                while (random_number--) {
-                    setVoxel(rand() % LAYER_COUNT, rand() % LAYER_COUNT, LAYER_COUNT - 1);
-                }
-            } else {
-                ++effectState[0];
-            }
+    fill(0x00);
+    setPlane(state->axis, state->position);
 
-            if (effectState[0] == LAYER_COUNT) {
-                forceFinishEffect();
-            }
-            lastExecutionTime = millis();
-        }
+    if ((state->position == 0 || state->position == LAYER_COUNT - 1) && shouldFinish) {
+        return TICK_FINISHED;
     }
-    else if (currentEffectIndex == 1)               // toggle random voxel
-    {
-        if (deltaTime >= 500)
-        {
-            uint8_t random_number = rand() % LAYER_COUNT;
 
-            while (random_number--) {
-                toggleVoxel(rand() % LAYER_COUNT, rand() % LAYER_COUNT, rand() % LAYER_COUNT);
-            }
-            lastExecutionTime = millis();
+    if (state->position == 0 && state->counter == 4) {
+        state->axis = nextAxis(state->axis);
+        state->counter = 0;
+        return TICK_DRAWN;
+    }
+
+    if (state->counter % 2 == 0) {
+        if (++state->position == LAYER_COUNT-1) {
+            ++state->counter;
+        }
+    } else {
+        if (--state->position == 0) {
+            ++state->counter;
         }
     }
-    else if (currentEffectIndex == 2)               // Plane bounce
-    {
-        // STATE:: 0=axis; 1=position; 2=counter
-        if (effectState[0] == 0) {
-            effectState[0] = AXIS_Z;
+    return TICK_DRAWN;
+}
+
+#define planeBounceFinish 0
+
+// ---------------------------------------------------------------------------------------
+// Sticky plane bounce: the cube fills up plane by plane and empties again
+// ---------------------------------------------------------------------------------------
+
+static void stickyPlaneBounceInit()
+{
+    effectState.stickyPlaneBounce.axis = AXIS_Z;
+}
+
+static uint8_t stickyPlaneBounceTick(uint16_t /* elapsed */, bool shouldFinish)
+{
+    stickyPlaneBounceState *state = &effectState.stickyPlaneBounce;
+
+    if (state->counter == 0) {
+        setPlane(state->axis, state->position);
+    } else {
+        clrPlane(state->axis, state->position);
+    }
+
+    if (state->position == LAYER_COUNT-1 && state->counter == 1) {
+        if (shouldFinish) {
+            return TICK_FINISHED;
         }
+        state->axis = nextAxis(state->axis);
+        state->position = 0;
+        state->counter = 0;
+        return TICK_DRAWN;
+    }
 
-        if (deltaTime >= 400)
-        {
-            fill(0x00);
-            if (effectState[0] == AXIS_Z) {
-                setPlaneZ(effectState[1]);
-            } else if (effectState[0] == AXIS_Y) {
-                setPlaneY(effectState[1]);
-            } else {
-                setPlaneX(effectState[1]);
-            }
+    if (++state->position == LAYER_COUNT) {
+        state->position = 0;
+        ++state->counter;
+    }
+    return TICK_DRAWN;
+}
 
-            if ((effectState[1] == 0 || effectState[1] == LAYER_COUNT - 1) && shouldFinish) {
-                forceFinishEffect();
-                return;
-            }
+#define stickyPlaneBounceFinish 0
 
-            if (effectState[1] == 0 && effectState[2] == 4) {
-                if (effectState[0] == AXIS_Z) {
-                    effectState[0] = AXIS_Y;
-                    effectState[2] = 0;
-                } else if (effectState[0] == AXIS_Y) {
-                    effectState[0] = AXIS_X;
-                    effectState[2] = 0;
-                } else if (effectState[0] == AXIS_X) {
-                    effectState[0] = AXIS_Z;
-                    effectState[2] = 0;
-                }
-                lastExecutionTime = millis();
-                return;
-            }
+// ---------------------------------------------------------------------------------------
+// Blink: flashes with an accelerating, then slowing down rate
+// ---------------------------------------------------------------------------------------
 
-            if (effectState[2] % 2 == 0) {
-                if (++effectState[1] == LAYER_COUNT-1) {
-                    ++effectState[2];
-                }
+// Converts the delay into frames once it has changed, so the ticks don't have to do
+// the 32 bit arithmetic of MS_TO_FRAMES(). Slowing down, the delay counts backwards.
+static void blinkDelayChanged(blinkState *state)
+{
+    uint8_t frames = MS_TO_FRAMES(751 - state->delay);
+
+    if (!state->slowingDown && MS_TO_FRAMES(state->delay) < frames) {
+        frames = MS_TO_FRAMES(state->delay);
+    }
+    state->darkFrames = frames;
+}
+
+static void blinkInit()
+{
+    effectState.blink.delay = 750;
+    blinkDelayChanged(&effectState.blink);
+}
+
+static uint8_t blinkTick(uint16_t elapsed, bool shouldFinish)
+{
+    blinkState *state = &effectState.blink;
+
+    if (!state->lit && elapsed >= state->darkFrames) {
+        if (state->delay == 0) {
+            state->delay = 750;
+
+            if (!state->slowingDown) {
+                state->slowingDown = true;
             } else {
-                if (--effectState[1] == 0) {
-                    ++effectState[2];
+                if (shouldFinish) {
+                    return TICK_FINISHED;
                 }
+                state->slowingDown = false;
             }
+        }
+        state->lit = true;
+        fill(0xFF);
+        return TICK_DRAWN;
+    } else if (elapsed >= MS_TO_FRAMES(100) && state->lit) {
+        uint16_t step = 15 + 1000 / (state->delay / 10 + 1);
 
-            lastExecutionTime = millis();
+        fill(0x00);
+        // the steps grow while the delay shrinks, the last one stops at 0 instead of
+        // wrapping around (the cycle would end only after hours)
+        state->delay = step < state->delay ? state->delay - step : 0;
+        blinkDelayChanged(state);
+        state->lit = false;
+        return TICK_DRAWN;
+    }
+    return TICK_IDLE;
+}
+
+#define blinkFinish 0
+
+// ---------------------------------------------------------------------------------------
+// Animation: plays the animation in the EEPROM, or the built-in one (See animation.h)
+// ---------------------------------------------------------------------------------------
+
+static void animationInit()
+{
+    if (!animationOpen(ANIMATION_EEPROM, 0)) {
+        animationOpen(ANIMATION_FLASH, defaultAnimation);
+    }
+}
+
+static uint8_t animationTick(uint16_t elapsed, bool shouldFinish)
+{
+    animationState *state = &effectState.animation;
+
+    if (elapsed < state->duration) {
+        return TICK_IDLE;
+    }
+    state->duration = animationNextFrame();
+    if (state->duration == 0) {
+        // the animation has passed
+        if (shouldFinish) {
+            return TICK_FINISHED;
+        }
+        animationRewind();
+        state->duration = animationNextFrame();
+        if (state->duration == 0) {
+            return TICK_FINISHED;       // broken data
         }
     }
-    else if (currentEffectIndex == 3)               // sticky plane bounce
-    {
-        // STATE:: 0=axis; 1=position; 2=counter
-        if (effectState[0] == 0) {
-            effectState[0] = AXIS_Z;
+    return TICK_DRAWN;
+}
+
+#define animationFinish 0
+
+// ---------------------------------------------------------------------------------------
+// Text: shows the text (See text.h) in all the modes, one after the other
+// ---------------------------------------------------------------------------------------
+
+#if TEXT_SUPPORTED
+#define textInit   0
+#define textFinish 0
+
+static uint8_t textTick(uint16_t /* elapsed */, bool shouldFinish)
+{
+    textState *state = &effectState.text;
+
+    fill(0x00);
+    while (!drawText(state->mode, state->step)) {
+        // the text has passed
+        if (shouldFinish) {
+            return TICK_FINISHED;
         }
+        state->mode = (state->mode + 1) % TEXT_MODES;
+        state->step = 0;
+    }
+    ++state->step;
+    return TICK_DRAWN;
+}
+#endif
 
-        if (deltaTime >= 400)
-        {
-            if (effectState[2] == 0) {
-                if (effectState[0] == AXIS_Z) {
-                    setPlaneZ(effectState[1]);
-                } else if (effectState[0] == AXIS_Y) {
-                    setPlaneY(effectState[1]);
-                } else {
-                    setPlaneX(effectState[1]);
-                }
-            } else {
-                if (effectState[0] == AXIS_Z) {
-                    clrPlaneZ(effectState[1]);
-                } else if (effectState[0] == AXIS_Y) {
-                    clrPlaneY(effectState[1]);
-                } else {
-                    clrPlaneX(effectState[1]);
-                }
-            }
+// ---------------------------------------------------------------------------------------
+// Life: a 3D cellular automaton, seeded again as soon as it dies out or repeats itself
+// ---------------------------------------------------------------------------------------
 
-            if (effectState[1] == LAYER_COUNT - 1 && effectState[2] == 1 && shouldFinish) {
-                forceFinishEffect();
-                return;
-            }
+// Fill the cube with random voxels and forget the previous generations. The history
+// starts out with the seed only: every hash is a valid CRC16, a cleared history would
+// match a generation hashing to 0.
+static void lifeSeed()
+{
+    lifeState *state = &effectState.life;
+    uint16_t hash;
+    uint8_t z, i;
 
-            if (effectState[1] == LAYER_COUNT-1 && effectState[2] == 1) {
-                if (effectState[0] == AXIS_Z) {
-                    effectState[0] = AXIS_Y;
-                    effectState[1] = 0;
-                    effectState[2] = 0;
-                } else if (effectState[0] == AXIS_Y) {
-                    effectState[0] = AXIS_X;
-                    effectState[1] = 0;
-                    effectState[2] = 0;
-                } else if (effectState[0] == AXIS_X) {
-                    effectState[0] = AXIS_Z;
-                    effectState[1] = 0;
-                    effectState[2] = 0;
-                }
-                lastExecutionTime = millis();
-                return;
-            }
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        randomSparseLayer(z, LIFE_DENSITY);
+    }
+    hash = frameHash();
+    for (i = 0; i < LIFE_HISTORY; ++i) {
+        state->history[i] = hash;
+    }
+    state->next = 0;
+}
 
-            if(++effectState[1] == LAYER_COUNT) {
-                effectState[1] = 0;
-                ++effectState[2];
-            }
+static void lifeInit()
+{
+    lifeSeed();
+}
+
+static uint8_t lifeTick(uint16_t /* elapsed */, bool shouldFinish)
+{
+    lifeState *state = &effectState.life;
+    uint16_t hash;
+    uint8_t i;
 
-            lastExecutionTime = millis();
+    if (shouldFinish) {
+        return TICK_FINISHED;
+    }
+    lifeGeneration(LIFE_SURVIVE_MIN, LIFE_SURVIVE_MAX, LIFE_BIRTH_MIN, LIFE_BIRTH_MAX);
+
+    // A generation seen before: the cube is empty, stands still or runs in a cycle of up
+    // to LIFE_HISTORY generations
+    hash = frameHash();
+    for (i = 0; i < LIFE_HISTORY; ++i) {
+        if (state->history[i] == hash) {
+            lifeSeed();
+            return TICK_DRAWN;
         }
     }
-    else if (currentEffectIndex == 4)               // Blink
-    {
-        // STATE: 0=variable delay; 1=LED state; 2=accelerating/slowing down
-        if (effectState[0] == 0) {
-            effectState[0] = 750;
+    state->history[state->next] = hash;
+    state->next = (state->next + 1) % LIFE_HISTORY;
+    return TICK_DRAWN;
+}
+
+#define lifeFinish 0
+
+// ---------------------------------------------------------------------------------------
+// Effect registry
+// ---------------------------------------------------------------------------------------
+
+// init and finish are 0 if the effect has nothing to set up or clean up
+struct EffectDescriptor {
+    void (*init)();
+    uint8_t (*tick)(uint16_t elapsed, bool shouldFinish);
+    void (*finish)();
+    uint16_t interval;          // minimal number of frames between two ticks
+};
+
+#define EFFECT_DESCRIPTOR(name, interval) { name##Init, name##Tick, name##Finish, MS_TO_FRAMES(interval) },
+static const EffectDescriptor effects[EFFECTS_COUNT] PROGMEM = {
+    EFFECT_LIST(EFFECT_DESCRIPTOR)
+};
+#undef EFFECT_DESCRIPTOR
+
+// Copy the descriptor of an effect from flash
+static void readDescriptor(uint8_t index, EffectDescriptor *descriptor)
+{
+    memcpy_P(descriptor, &effects[index], sizeof(EffectDescriptor));
+}
+
+// ---------------------------------------------------------------------------------------
+// Effect engine
+// ---------------------------------------------------------------------------------------
+
+// Start a new effect.
+// NOTE: This will force finish the current effect!
+void startEffect(uint8_t index)
+{
+    EffectDescriptor descriptor;
+
+    if (index < EFFECTS_COUNT) {
+        currentEffectIndex = index;
+    }
+    fill(0x00);
+    present(true);
+    setBrightness(MAX_BRIGHTNESS);
+    memset(&effectState, 0x00, sizeof(effectState));
+    if (currentEffectIndex != NO_EFFECT_ACTIVE) {
+        readDescriptor(currentEffectIndex, &descriptor);
+        if (descriptor.init) {
+            descriptor.init();
         }
-        if (effectState[1] == 0 && ((effectState[2] == 0 && deltaTime >= effectState[0]) || deltaTime >= 751 - effectState[0])) {
-            if (effectState[0] == 0) {
-                effectState[0] = 750;
-
-                if (effectState[2] == 0) {
-                    effectState[2] = 1;
-                } else {
-                    if (shouldFinish) {
-                        forceFinishEffect();
-                        return;
-                    }
-                    effectState[2] = 0;
-                }
-            }
-            effectState[1] = 1;
-            fill(0xFF);
-            lastExecutionTime = millis();
-        } else if (deltaTime >= 100 && effectState[1] == 1) {
-            fill(0x00);
-            effectState[0] = effectState[0] - (15+(1000/(effectState[0]/10)));
-            effectState[1] = 0;
-            lastExecutionTime = millis();
+    }
+}
+
+// Get current effect index
+uint8_t getCurrentEffect()
+{
+    return currentEffectIndex;
+}
+
+// Get previous effect index
+uint8_t getPreviousEffect()
+{
+    return previousEffectIndex;
+}
+
+// Checks if the current effect has been finished
+bool isEffectFinished()
+{
+    return currentEffectIndex == NO_EFFECT_ACTIVE;
+}
+
+// Finish effect right now. This may look strange
+void forceFinishEffect()
+{
+    EffectDescriptor descriptor;
+
+    if (currentEffectIndex != NO_EFFECT_ACTIVE) {
+        readDescriptor(currentEffectIndex, &descriptor);
+        if (descriptor.finish) {
+            descriptor.finish();
         }
     }
-    // TODO: add more effects
-    // TODO: add text functions to ARDUINO_X8 boards
-}
\ No newline at end of file
+    fill(0x00);
+    present(true);
+    elapsedFrames = 0;
+    memset(&effectState, 0x00, sizeof(effectState));      // reset effect memory
+    previousEffectIndex = currentEffectIndex;
+    currentEffectIndex = NO_EFFECT_ACTIVE;
+}
+
+// Advances the effect by a number of frames (See scheduler.h)
+void processEffect(bool shouldFinish, uint8_t frames)
+{
+    EffectDescriptor descriptor;
+
+    if (currentEffectIndex == NO_EFFECT_ACTIVE) {
+        return;
+    }
+    if (elapsedFrames > 0xFFFF - frames) {
+        elapsedFrames = 0xFFFF;
+    } else {
+        elapsedFrames += frames;
+    }
+    readDescriptor(currentEffectIndex, &descriptor);
+    if (elapsedFrames < descriptor.interval) {
+        return;
+    }
+
+    switch (descriptor.tick(elapsedFrames, shouldFinish)) {
+    case TICK_DRAWN:
+        // Show the frame drawn during this cycle, the next tick counts from here
+        present(true);
+        elapsedFrames = 0;
+        break;
+    case TICK_FINISHED:
+        forceFinishEffect();
+        break;
+    }
+}
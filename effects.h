@@ -8,16 +8,53 @@
 #define LEDCUBE_EFFECTS_H
 
 #include <Arduino.h>
+#include "draw.h"
+#include "text.h"
 
-#define EFFECTS_COUNT 5
-#define MAX_BRIGHTNESS 10
+// Effect registry, one line per effect: EFFECT(name, minimal time between two ticks [ms])
+// The effects are played in this order. effects.cpp has to provide the state
+// struct <name>State and the functions <name>Init(), <name>Tick() and <name>Finish().
+// <name>Init and <name>Finish are defined as 0 if there is nothing to do.
+#define EFFECT_LIST(EFFECT) \
+    EFFECT(rain,              1000) \
+    EFFECT(toggleRandom,       500) \
+    EFFECT(planeBounce,        400) \
+    EFFECT(stickyPlaneBounce,  400) \
+    EFFECT(blink,                0) \
+    EFFECT(animation,            0) \
+    TEXT_EFFECT(EFFECT) \
+    EFFECT(life,               200)
+
+// Scrolling text (See text.h), only on cubes which can show the font
+#if TEXT_SUPPORTED
+#define TEXT_EFFECT(EFFECT) EFFECT(text, 100)
+#else
+#define TEXT_EFFECT(EFFECT)
+#endif
+
+// Rule of the life effect (See lifeGeneration() in draw.h). S5-6 B4-5 keeps changing
+// for hundreds of generations, even on the 4x4x4 cube.
+#ifndef LIFE_SURVIVE_MIN
+#define LIFE_SURVIVE_MIN 5
+#define LIFE_SURVIVE_MAX 6
+#define LIFE_BIRTH_MIN   4
+#define LIFE_BIRTH_MAX   5
+#endif
+
+#define EFFECT_INDEX(name, interval) EFFECT_##name,
+enum {
+    EFFECT_LIST(EFFECT_INDEX)
+    EFFECTS_COUNT
+};
+#undef EFFECT_INDEX
 
 void startEffect(uint8_t index);
 uint8_t getCurrentEffect();
 uint8_t getPreviousEffect();
 bool isEffectFinished();
 
-void processEffect(bool shouldFinish);
+// Advances the effect by a number of frames (See scheduler.h)
+void processEffect(bool shouldFinish, uint8_t frames);
 void forceFinishEffect();
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,22 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_FONT_H
+#define LEDCUBE_FONT_H
+
+#include <Arduino.h>
+
+// 5x7 font for the printable ASCII characters, stored in flash (475 bytes).
+// Every glyph consists of FONT_WIDTH columns, bit 0 of a column is the top row.
+#define FONT_WIDTH  5
+#define FONT_HEIGHT 7
+#define FONT_FIRST  ' '
+#define FONT_LAST   '~'
+
+// Column of a glyph (0..FONT_WIDTH-1), characters without a glyph show as '?'
+uint8_t fontColumn(char c, uint8_t column);
+
+#endif
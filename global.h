@@ -15,8 +15,13 @@
 #define LAYER_COUNT 4
 #elif ARDUINO_X8
 #define LAYER_COUNT 8
+#elif HOST_X16
+#define LAYER_COUNT 16          // host builds only, to simulate a bigger cube
 #else
 #error "Please specify cube size in Arduino configuration"
 #endif
 
+#define LAYER_SIZE (LAYER_COUNT*LAYER_COUNT/8)  // bytes per layer (See cube.h)
+#define FRAME_SIZE (LAYER_COUNT*LAYER_SIZE)
+
 #endif
\ No newline at end of file
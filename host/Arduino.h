@@ -0,0 +1,125 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Stand-in for the Arduino core when building the cube code on a host machine.
+// Only the parts used by the LEDcube sources are provided.
+
+#ifndef LEDCUBE_HOST_ARDUINO_H
+#define LEDCUBE_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/interrupt.h>
+
+#ifndef F_CPU
+#define F_CPU 14745600L
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+// ---------------------------------------------------------------------------------------
+// Time
+// ---------------------------------------------------------------------------------------
+
+// Returns the virtual time in milliseconds. It only moves when the host advances it.
+unsigned long millis();
+// Advance the virtual clock by the given amount of milliseconds
+void hostAdvanceMillis(unsigned long ms);
+// Set the virtual clock to an absolute value
+void hostSetMillis(unsigned long ms);
+
+// ---------------------------------------------------------------------------------------
+// Digital I/O
+// ---------------------------------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// ---------------------------------------------------------------------------------------
+// Registers
+// ---------------------------------------------------------------------------------------
+
+extern volatile uint8_t SREG;
+
+extern volatile uint8_t PORTA, PORTB, PORTC, PORTD;
+extern volatile uint8_t DDRA, DDRB, DDRC, DDRD;
+extern volatile uint8_t PINA, PINB, PINC, PIND;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK, TIFR;
+extern volatile uint16_t OCR1A, TCNT1;
+extern volatile uint8_t UBRRH, UBRRL, UCSRA, UCSRB, UCSRC, UDR;
+extern volatile uint8_t EECR, EEDR;
+extern volatile uint16_t EEAR;
+
+// Completes the EEPROM write started with EEWE (it takes 8.5 ms on the AVR). The host
+// code calls the EEPROM ready ISR itself afterwards, if EERIE is set.
+void hostEepromWriteDone();
+
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// Timer1
+#define WGM12  3
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define OCIE1A 4
+#define OCF1A  4
+
+// USART
+#define U2X    1
+#define DOR    3
+#define UDRE   5
+#define UCSZ0  1
+#define UCSZ1  2
+#define URSEL  7
+#define TXEN   3
+#define RXEN   4
+#define RXCIE  7
+
+// EEPROM
+#define EERE   0
+#define EEWE   1
+#define EEMWE  2
+#define EERIE  3
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Host tool for the animation container (See ../animation.h).
+// Build with -DARDUINO_X4, -DARDUINO_X8 or -DHOST_X16 (see Makefile).
+//
+//   anim record <effect> <frames> <out.raw>   record an effect, one frame per scheduler frame
+//   anim demo <out.raw>                       draw the built-in animation
+//   anim encode <in.raw> <out.bin>            encode raw frames (FRAME_SIZE bytes each)
+//   anim header                               print the head of ../animations.cpp
+//   anim source <in.bin>                      print a container as PROGMEM array for this cube
+//   anim play <in.bin>                        decode a container and print its statistics
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "global.h"
+#include "draw.h"
+#include "effects.h"
+#include "animation.h"
+#include "encoder.h"
+#include "random.h"
+
+#define MAX_FRAMES 20000
+#define DEMO_HOLD  8            // scheduler frames per demo step
+
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][LAYER_SIZE];
+extern uint8_t presentedBuffer;
+
+static uint8_t frames[MAX_FRAMES][FRAME_SIZE];
+static uint8_t container[MAX_FRAMES * (FRAME_SIZE + FRAME_SIZE / 128 + 3) + ANIMATION_HEADER_SIZE];
+
+static size_t readFile(const char *name, uint8_t *data, size_t size)
+{
+    FILE *file = fopen(name, "rb");
+    size_t length;
+
+    if (!file) {
+        perror(name);
+        exit(1);
+    }
+    length = fread(data, 1, size, file);
+    fclose(file);
+    return length;
+}
+
+static void writeFile(const char *name, const uint8_t *data, size_t length)
+{
+    FILE *file = fopen(name, "wb");
+
+    if (!file || fwrite(data, 1, length, file) != length) {
+        perror(name);
+        exit(1);
+    }
+    fclose(file);
+}
+
+// Keep the presented frame for hold scheduler frames
+static size_t capture(size_t count, uint8_t hold)
+{
+    while (hold-- && count < MAX_FRAMES) {
+        memcpy(frames[count++], cubeBuffer[presentedBuffer][0], FRAME_SIZE);
+    }
+    return count;
+}
+
+static size_t record(uint8_t effect, size_t count)
+{
+    size_t i;
+
+    seedRandom(1);
+    startEffect(effect);
+    for (i = 0; i < count && i < MAX_FRAMES; ++i) {
+        processEffect(false, 1);
+        if (isEffectFinished()) {
+            startEffect(effect);
+        }
+        capture(i, 1);
+    }
+    forceFinishEffect();
+    return i;
+}
+
+// Wireframe box growing out of a corner and shrinking into the opposite one
+static size_t demo()
+{
+    size_t count = 0;
+    uint8_t s;
+
+    for (s = 0; s < LAYER_COUNT; ++s) {
+        fill(0x00);
+        box(BOX_FRAME, 0, 0, 0, s, s, s);
+        present(false);
+        count = capture(count, DEMO_HOLD);
+    }
+    for (s = 1; s < LAYER_COUNT; ++s) {
+        fill(0x00);
+        box(BOX_FRAME, s, s, s, LAYER_COUNT-1, LAYER_COUNT-1, LAYER_COUNT-1);
+        present(false);
+        count = capture(count, DEMO_HOLD);
+    }
+    return count;
+}
+
+static void header()
+{
+    printf("/*\n"
+           " * Project: LEDcube\n"
+           " * Author:  Sandro Lutz\n"
+           " * Email:   sandro.lutz@temparus.ch\n"
+           " */\n"
+           "\n"
+           "// Built-in animation (See animation.h)\n"
+           "// Generated by \"make animations\" in the folder host, don't edit.\n"
+           "\n"
+           "#include <avr/pgmspace.h>\n"
+           "#include \"animation.h\"\n");
+}
+
+static void source(const uint8_t *data, size_t length)
+{
+    size_t i;
+
+#ifdef ARDUINO_X4
+    printf("\n#ifdef ARDUINO_X4\n");
+#elif ARDUINO_X8
+    printf("\n#ifdef ARDUINO_X8\n");
+#else
+    printf("\n#ifdef HOST_X16\n");
+#endif
+    printf("// %ux%ux%u: %u frames, %zu bytes\n", LAYER_COUNT, LAYER_COUNT, LAYER_COUNT,
+           data[2] | (data[3] << 8), length);
+    printf("const uint8_t defaultAnimation[] PROGMEM = {");
+    for (i = 0; i < length; ++i) {
+        printf("%s0x%02X,", i % 12 ? " " : "\n    ", data[i]);
+    }
+    printf("\n};\n#endif\n");
+}
+
+static void play(const uint8_t *data, size_t length)
+{
+    unsigned long frameCount = 0;
+    unsigned long shown = 0;
+    uint8_t duration;
+
+    if (!animationOpen(ANIMATION_FLASH, data)) {
+        fprintf(stderr, "not an animation for a %ux%ux%u cube\n", LAYER_COUNT, LAYER_COUNT, LAYER_COUNT);
+        exit(1);
+    }
+    while ((duration = animationNextFrame())) {
+        ++frameCount;
+        shown += duration;
+    }
+    printf("%lu frames (%lu scheduler frames), %zu bytes, %.1f bytes/frame\n", frameCount, shown,
+           length, (double)length / frameCount);
+}
+
+int main(int argc, char **argv)
+{
+    size_t count;
+
+    if (argc == 5 && !strcmp(argv[1], "record")) {
+        count = record(atoi(argv[2]), atoi(argv[3]));
+        writeFile(argv[4], frames[0], count * FRAME_SIZE);
+    } else if (argc == 3 && !strcmp(argv[1], "demo")) {
+        count = demo();
+        writeFile(argv[2], frames[0], count * FRAME_SIZE);
+    } else if (argc == 4 && !strcmp(argv[1], "encode")) {
+        count = readFile(argv[2], frames[0], sizeof(frames)) / FRAME_SIZE;
+        writeFile(argv[3], container, encodeAnimation(frames[0], count, LAYER_COUNT, FRAME_SIZE, container));
+    } else if (argc == 2 && !strcmp(argv[1], "header")) {
+        header();
+    } else if (argc == 3 && !strcmp(argv[1], "source")) {
+        source(container, readFile(argv[2], container, sizeof(container)));
+    } else if (argc == 3 && !strcmp(argv[1], "play")) {
+        play(container, readFile(argv[2], container, sizeof(container)));
+    } else {
+        fprintf(stderr, "usage: %s record <effect> <frames> <out.raw> | demo <out.raw> |\n"
+                "       encode <in.raw> <out.bin> | header | source <in.bin> | play <in.bin>\n", argv[0]);
+        return 1;
+    }
+    return 0;
+}
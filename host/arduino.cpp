@@ -0,0 +1,68 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+
+volatile uint8_t SREG;
+volatile uint8_t PORTA, PORTB, PORTC, PORTD;
+volatile uint8_t DDRA, DDRB, DDRC, DDRD;
+volatile uint8_t PINA, PINB, PINC, PIND;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK, TIFR;
+volatile uint16_t OCR1A, TCNT1;
+volatile uint8_t UBRRH, UBRRL, UCSRA, UCSRB, UCSRC, UDR;
+volatile uint8_t EECR, EEDR;
+volatile uint16_t EEAR;
+
+// EEPROM content, erased when the program starts (See avr/eeprom.h)
+uint8_t hostEeprom[E2END+1];
+static struct EraseEeprom {
+    EraseEeprom() { memset(hostEeprom, 0xFF, sizeof(hostEeprom)); }
+} eraseEeprom;
+
+static unsigned long hostMillis;
+
+void hostEepromWriteDone()
+{
+    if ((EECR & (1<<EEWE)) && (EECR & (1<<EEMWE))) {
+        hostEeprom[EEAR & E2END] = EEDR;
+    }
+    EECR &= ~((1<<EEWE) | (1<<EEMWE));
+}
+
+unsigned long millis()
+{
+    return hostMillis;
+}
+
+void hostAdvanceMillis(unsigned long ms)
+{
+    hostMillis += ms;
+}
+
+void hostSetMillis(unsigned long ms)
+{
+    hostMillis = ms;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void) pin;
+    (void) mode;
+}
+
+// All buttons are released (pull-up)
+int digitalRead(uint8_t pin)
+{
+    (void) pin;
+    return HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    (void) pin;
+    (void) value;
+}
@@ -0,0 +1,51 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Stand-in for avr-libc's <avr/eeprom.h>
+// The EEPROM is a byte array (hostEeprom in arduino.cpp), erased to 0xFF.
+
+#ifndef LEDCUBE_HOST_AVR_EEPROM_H
+#define LEDCUBE_HOST_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Last EEPROM address (ATmega8: 512 bytes, ATmega32: 1 KB)
+#ifndef E2END
+#ifdef ARDUINO_X4
+#define E2END 0x1FF
+#else
+#define E2END 0x3FF
+#endif
+#endif
+
+extern uint8_t hostEeprom[E2END+1];
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address)
+{
+    return hostEeprom[(uintptr_t)address & E2END];
+}
+
+static inline void eeprom_write_byte(uint8_t *address, uint8_t value)
+{
+    hostEeprom[(uintptr_t)address & E2END] = value;
+}
+
+static inline void eeprom_read_block(void *destination, const void *source, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; ++i) {
+        ((uint8_t *)destination)[i] = eeprom_read_byte((const uint8_t *)source + i);
+    }
+}
+
+static inline void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+    eeprom_write_byte(address, value);
+}
+
+#endif
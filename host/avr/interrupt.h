@@ -0,0 +1,23 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Stand-in for avr-libc's <avr/interrupt.h>
+// There are no interrupts on the host: an ISR is a plain function which the host code
+// may call, the global interrupt flag is only stored in SREG.
+
+#ifndef LEDCUBE_HOST_AVR_INTERRUPT_H
+#define LEDCUBE_HOST_AVR_INTERRUPT_H
+
+#include <stdint.h>
+
+extern volatile uint8_t SREG;
+
+#define cli() (SREG &= ~0x80)
+#define sei() (SREG |= 0x80)
+
+#define ISR(vector) extern "C" void vector(void); extern "C" void vector(void)
+
+#endif
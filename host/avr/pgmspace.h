@@ -0,0 +1,23 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Stand-in for avr-libc's <avr/pgmspace.h>
+// The host has a single address space: PROGMEM data is ordinary constant data.
+
+#ifndef LEDCUBE_HOST_AVR_PGMSPACE_H
+#define LEDCUBE_HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+#define memcpy_P(destination, source, size) memcpy((destination), (source), (size))
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Stand-in for avr-libc's <avr/sleep.h>
+// The host never sleeps: sleep_cpu() returns immediately.
+
+#ifndef LEDCUBE_HOST_AVR_SLEEP_H
+#define LEDCUBE_HOST_AVR_SLEEP_H
+
+#define SLEEP_MODE_IDLE 0
+
+#define set_sleep_mode(mode) ((void)(mode))
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()
+
+#endif
@@ -0,0 +1,1488 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Host benchmark for the draw primitives and effects.
+// Build with -DARDUINO_X4, -DARDUINO_X8 or -DHOST_X16 (see Makefile).
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "draw.h"
+#include "effects.h"
+#include "protocol.h"
+#include "encoder.h"
+#include "scheduler.h"
+#include "animation.h"
+#include "upload.h"
+#include "random.h"
+#include "uart.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#define PRIMITIVE_ITERATIONS 2000000UL
+#define EFFECT_TICKS         200000UL
+#define EFFECT_TICK_FRAMES   200        // longer than any effect delay -> every call is a tick
+#define DECODE_FRAMES        200000UL
+#define RECORD_FRAMES        2000
+#define BAUD_RATE            115200
+#define REFRESH_TICKS        1560       // Timer1 ticks per refresh (See LEDcube.ino)
+#define SCHEDULE_SECONDS     60
+#define SLOW_FRAME_INTERVAL  50         // every 50th frame ...
+#define SLOW_FRAME_TICKS     (3 * TICKS_PER_FRAME)  // ... takes three frame periods
+#define EEPROM_WRITE_MS      8.5        // one EEPROM byte (ATmega8/32 data sheet)
+#define BYTE_TICKS           ((F_CPU / 8) * 10 / BAUD_RATE)   // one byte on the serial line
+#define STREAM_TIMEOUT       (F_CPU / 8 / 50)                 // host resends 20 ms after the last packet
+#define STREAM_LIMIT         (300UL * (F_CPU / 8))            // a stream fails after 300 s
+#define STALL_INTERVAL       (F_CPU / 8 / 20)                 // the main loop stalls every 50 ms ...
+#define STALL_TICKS          (F_CPU / 8 / 500)                // ... for 2 ms
+#define LINK_ERROR_RATE      2000       // noisy link: one byte in 2000 has a flipped bit
+#define PLAY_FRAMES          500
+#define PLAY_INTERVAL        0.020      // s between two frames of the timeline (50 fps)
+#define PRESENT_LEAD         0.100      // s timed frames are sent ahead
+#define SEND_JITTER          0.016      // s a packet leaves late at most (USB and OS latency)
+#define RECEIVE_JITTER       0.002      // s a reply arrives late at most
+#define HOST_DRIFT           100e-6     // the host clock runs 100 ppm fast ...
+#define HOST_OFFSET          12.3       // ... and started 12.3 s earlier
+#define SYNC_INTERVAL        1.0        // s between two clock syncs ...
+#define SYNC_SAMPLES         8          // ... of PACKET_CLOCK requests (the fastest one counts)
+#define CHECK_FRAMES         100        // random frames per reference check
+#define LIFE_SEEDS           32         // random seeds of density 7/256 .. 255/256 ...
+#define LIFE_GENERATIONS     50         // ... each advanced by this many generations
+#define REFRESH_SECONDS      (REFRESH_TICKS / (F_CPU / 8.0))
+#define BYTE_SECONDS         (BYTE_TICKS / (F_CPU / 8.0))
+
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][LAYER_SIZE];
+extern uint8_t presentedBuffer;
+extern uint8_t (*cube)[LAYER_SIZE];
+extern "C" void EE_RDY_vect(void);
+
+static uint8_t recorded[RECORD_FRAMES][FRAME_SIZE];
+
+static volatile uint8_t sink;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Fold the cube buffers into a byte so the compiler can't drop the drawing code
+static void consume()
+{
+    uint8_t value = 0;
+    for (unsigned i = 0; i < sizeof(cubeBuffer); ++i) {
+        value ^= ((uint8_t *)cubeBuffer)[i];
+    }
+    sink = value;
+}
+
+// ---------------------------------------------------------------------------------------
+// Primitives
+// ---------------------------------------------------------------------------------------
+
+static void benchFill(unsigned long i)       { fill((uint8_t)i); }
+static void benchSetPlaneX(unsigned long i)  { setPlaneX(i % LAYER_COUNT); }
+static void benchClrPlaneX(unsigned long i)  { clrPlaneX(i % LAYER_COUNT); }
+static void benchSetPlaneY(unsigned long i)  { setPlaneY(i % LAYER_COUNT); }
+static void benchClrPlaneY(unsigned long i)  { clrPlaneY(i % LAYER_COUNT); }
+static void benchSetPlaneZ(unsigned long i)  { setPlaneZ(i % LAYER_COUNT); }
+static void benchClrPlaneZ(unsigned long i)  { clrPlaneZ(i % LAYER_COUNT); }
+static void benchToggleVoxel(unsigned long i)
+{
+    toggleVoxel(i % LAYER_COUNT, (i / LAYER_COUNT) % LAYER_COUNT, (i / (LAYER_COUNT*LAYER_COUNT)) % LAYER_COUNT);
+}
+// A random voxel the way the effects used to pick it, and from the xorshift generator
+static void benchRandVoxel(unsigned long i)
+{
+    toggleVoxel(rand() % LAYER_COUNT, rand() % LAYER_COUNT, rand() % LAYER_COUNT);
+}
+static void benchRandomVoxel(unsigned long i)
+{
+    uint8_t x = randomCoordinate();
+    uint8_t y = randomCoordinate();
+    uint8_t z = randomCoordinate();
+
+    toggleVoxel(x, y, z);
+}
+static void benchRandomSparseLayer(unsigned long i)
+{
+    randomSparseLayer(i % LAYER_COUNT, 6);
+}
+static void benchLife(unsigned long i)
+{
+    lifeGeneration(LIFE_SURVIVE_MIN, LIFE_SURVIVE_MAX, LIFE_BIRTH_MIN, LIFE_BIRTH_MAX);
+}
+static void benchFrameHash(unsigned long i)  { sink = frameHash(); }
+static void benchBoxFilled(unsigned long i)
+{
+    box(BOX_FILLED, i % LAYER_COUNT, 0, 1, LAYER_COUNT-1, (i+1) % LAYER_COUNT, LAYER_COUNT-1);
+}
+static void benchBoxWalls(unsigned long i)
+{
+    box(BOX_WALLS, i % LAYER_COUNT, 0, 1, LAYER_COUNT-1, (i+1) % LAYER_COUNT, LAYER_COUNT-1);
+}
+static void benchBoxFrame(unsigned long i)
+{
+    box(BOX_FRAME, i % LAYER_COUNT, 0, 1, LAYER_COUNT-1, (i+1) % LAYER_COUNT, LAYER_COUNT-1);
+}
+
+// Former float implementation of line(). It only steps along X and is kept as reference.
+static void lineFloat(uint8_t x1, uint8_t y1, uint8_t z1, uint8_t x2, uint8_t y2, uint8_t z2)
+{
+    float xy;
+    float xz;
+    uint8_t x,y,z;
+
+    if (x1 > x2) {
+        int tmp;
+        tmp = x2; x2 = x1; x1 = tmp;
+        tmp = y2; y2 = y1; y1 = tmp;
+        tmp = z2; z2 = z1; z1 = tmp;
+    }
+    if (y1 > y2) {
+        xy = (float) (y1 - y2) / (float) (x2 - x1);
+    } else {
+        xy = (float) (y2 - y1) / (float) (x2 - x1);
+    }
+    if (z1 > z2) {
+        xz = (float) (z1 - z2) / (float) (x2 - x1);
+    } else {
+        xz = (float) (z2 - z1) / (float) (x2 - x1);
+    }
+    for (x = x1; x <= x2; ++x) {
+        y = (xy * (x - x1)) + y1;
+        z = (xz * (x - x1)) + z1;
+        setVoxel(x, y, z);
+    }
+}
+
+// Corner to corner lines
+static void benchLine(unsigned long i)
+{
+    uint8_t c = i % 4;
+    line(0, (c & 1) ? LAYER_COUNT-1 : 0, (c & 2) ? LAYER_COUNT-1 : 0,
+         LAYER_COUNT-1, (c & 1) ? 0 : LAYER_COUNT-1, (c & 2) ? 0 : LAYER_COUNT-1);
+}
+static void benchLineFloat(unsigned long i)
+{
+    uint8_t c = i % 4;
+    lineFloat(0, (c & 1) ? LAYER_COUNT-1 : 0, (c & 2) ? LAYER_COUNT-1 : 0,
+              LAYER_COUNT-1, (c & 1) ? 0 : LAYER_COUNT-1, (c & 2) ? 0 : LAYER_COUNT-1);
+}
+// Lines along the X axis, written as whole rows
+static void benchLineRow(unsigned long i)
+{
+    line(0, i % LAYER_COUNT, (i / LAYER_COUNT) % LAYER_COUNT, LAYER_COUNT-1, i % LAYER_COUNT, (i / LAYER_COUNT) % LAYER_COUNT);
+}
+// Lines with Y and Z as major axis
+static void benchLineY(unsigned long i)
+{
+    line(i % 2, 0, LAYER_COUNT-1, LAYER_COUNT/2, LAYER_COUNT-1, LAYER_COUNT/2);
+}
+static void benchLineZ(unsigned long i)
+{
+    line(LAYER_COUNT-1, i % 2, LAYER_COUNT-1, LAYER_COUNT/2, LAYER_COUNT/2, 0);
+}
+static void benchSetVoxelLevel(unsigned long i)
+{
+    setVoxelLevel(i % LAYER_COUNT, (i / LAYER_COUNT) % LAYER_COUNT, (i / 7) % LAYER_COUNT, i & MAX_LEVEL);
+}
+static void benchFillLevel(unsigned long i)  { fillLevel(i & MAX_LEVEL); }
+static void benchPresent(unsigned long i)    { present(i & 1); }
+static void benchShiftX(unsigned long i)     { shift(AXIS_X, (i & 1) ? 1 : -1); }
+static void benchShiftY(unsigned long i)     { shift(AXIS_Y, (i & 1) ? 1 : -1); }
+static void benchShiftZ(unsigned long i)     { shift(AXIS_Z, (i & 1) ? 1 : -1); }
+static void benchRotateX(unsigned long i)    { rotate(AXIS_X, (i & 1) ? 1 : -1); }
+static void benchRotateY(unsigned long i)    { rotate(AXIS_Y, (i & 1) ? 1 : -1); }
+static void benchRotateZ(unsigned long i)    { rotate(AXIS_Z, (i & 1) ? 1 : -1); }
+static void benchRotate90X(unsigned long i)  { rotate90(AXIS_X, (i & 1) ? 1 : -1); }
+static void benchRotate90Y(unsigned long i)  { rotate90(AXIS_Y, (i & 1) ? 1 : -1); }
+static void benchRotate90Z(unsigned long i)  { rotate90(AXIS_Z, (i & 1) ? 1 : -1); }
+static void benchMirrorX(unsigned long i)    { mirror(AXIS_X); }
+static void benchMirrorY(unsigned long i)    { mirror(AXIS_Y); }
+static void benchMirrorZ(unsigned long i)    { mirror(AXIS_Z); }
+static void benchTransposeX(unsigned long i) { transpose(AXIS_X); }
+static void benchTransposeY(unsigned long i) { transpose(AXIS_Y); }
+static void benchTransposeZ(unsigned long i) { transpose(AXIS_Z); }
+
+// A filled box of half the cube size moving through the cube, partly clipped
+static uint8_t spriteData[(LAYER_COUNT/2) * (LAYER_COUNT/2) * SPRITE_ROW_BYTES(LAYER_COUNT/2)];
+static const Sprite sprite = { LAYER_COUNT/2, LAYER_COUNT/2, LAYER_COUNT/2, spriteData };
+static void benchBlit(unsigned long i)
+{
+    int8_t position = (int8_t)(i % (2*LAYER_COUNT)) - LAYER_COUNT/2;
+    blit(&sprite, position, position / 2, 1, (i / (2*LAYER_COUNT)) & 0x03);
+}
+
+struct Primitive {
+    const char *name;
+    void (*run)(unsigned long i);
+    unsigned long iterations;
+};
+
+static const Primitive primitives[] = {
+    { "fill",        benchFill,        PRIMITIVE_ITERATIONS },
+    { "toggleVoxel", benchToggleVoxel, PRIMITIVE_ITERATIONS },
+    { "voxel rand()", benchRandVoxel,  PRIMITIVE_ITERATIONS },
+    { "voxel random", benchRandomVoxel, PRIMITIVE_ITERATIONS },
+    { "sparse layer", benchRandomSparseLayer, PRIMITIVE_ITERATIONS },
+    { "setPlaneX",   benchSetPlaneX,   PRIMITIVE_ITERATIONS },
+    { "clrPlaneX",   benchClrPlaneX,   PRIMITIVE_ITERATIONS },
+    { "setPlaneY",   benchSetPlaneY,   PRIMITIVE_ITERATIONS },
+    { "clrPlaneY",   benchClrPlaneY,   PRIMITIVE_ITERATIONS },
+    { "setPlaneZ",   benchSetPlaneZ,   PRIMITIVE_ITERATIONS },
+    { "clrPlaneZ",   benchClrPlaneZ,   PRIMITIVE_ITERATIONS },
+    { "box filled",  benchBoxFilled,   PRIMITIVE_ITERATIONS },
+    { "box walls",   benchBoxWalls,    PRIMITIVE_ITERATIONS },
+    { "box frame",   benchBoxFrame,    PRIMITIVE_ITERATIONS },
+    { "line",        benchLine,        PRIMITIVE_ITERATIONS },
+    { "line (float)", benchLineFloat,  PRIMITIVE_ITERATIONS },
+    { "line row",    benchLineRow,     PRIMITIVE_ITERATIONS },
+    { "line Y",      benchLineY,       PRIMITIVE_ITERATIONS },
+    { "line Z",      benchLineZ,       PRIMITIVE_ITERATIONS },
+    { "setVoxelLevel", benchSetVoxelLevel, PRIMITIVE_ITERATIONS },
+    { "fillLevel",   benchFillLevel,   PRIMITIVE_ITERATIONS },
+    { "present",     benchPresent,     PRIMITIVE_ITERATIONS },
+    { "shift X",     benchShiftX,      PRIMITIVE_ITERATIONS },
+    { "shift Y",     benchShiftY,      PRIMITIVE_ITERATIONS },
+    { "shift Z",     benchShiftZ,      PRIMITIVE_ITERATIONS },
+    { "rotate X",    benchRotateX,     PRIMITIVE_ITERATIONS },
+    { "rotate Y",    benchRotateY,     PRIMITIVE_ITERATIONS },
+    { "rotate Z",    benchRotateZ,     PRIMITIVE_ITERATIONS },
+    { "rotate90 X",  benchRotate90X,   PRIMITIVE_ITERATIONS },
+    { "rotate90 Y",  benchRotate90Y,   PRIMITIVE_ITERATIONS },
+    { "rotate90 Z",  benchRotate90Z,   PRIMITIVE_ITERATIONS },
+    { "mirror X",    benchMirrorX,     PRIMITIVE_ITERATIONS },
+    { "mirror Y",    benchMirrorY,     PRIMITIVE_ITERATIONS },
+    { "mirror Z",    benchMirrorZ,     PRIMITIVE_ITERATIONS },
+    { "transpose X", benchTransposeX,  PRIMITIVE_ITERATIONS },
+    { "transpose Y", benchTransposeY,  PRIMITIVE_ITERATIONS },
+    { "transpose Z", benchTransposeZ,  PRIMITIVE_ITERATIONS },
+    { "blit",        benchBlit,        PRIMITIVE_ITERATIONS },
+    { "life",        benchLife,        PRIMITIVE_ITERATIONS / 10 },
+    { "frameHash",   benchFrameHash,   PRIMITIVE_ITERATIONS },
+};
+
+static void runPrimitive(const Primitive *p)
+{
+    unsigned long i;
+    double start;
+    double elapsed;
+
+    fill(0x5A);
+    start = now();
+    for (i = 0; i < p->iterations; ++i) {
+        p->run(i);
+    }
+    elapsed = now() - start;
+    consume();
+
+    printf("  %-14s %10.1f ns/op %14.0f ops/s\n", p->name, elapsed / p->iterations,
+           p->iterations * 1e9 / elapsed);
+}
+
+// ---------------------------------------------------------------------------------------
+// Effects
+// ---------------------------------------------------------------------------------------
+
+// Every call of processEffect() advances the effect by more frames than any effect
+// delay, so each call is an effect tick producing a frame.
+static void runEffect(uint8_t index)
+{
+    unsigned long i;
+    double start;
+    double elapsed;
+
+    seedRandom(1);
+    startEffect(index);
+
+    start = now();
+    for (i = 0; i < EFFECT_TICKS; ++i) {
+        processEffect(false, EFFECT_TICK_FRAMES);
+        if (isEffectFinished()) {
+            startEffect(index);
+        }
+    }
+    elapsed = now() - start;
+    consume();
+    forceFinishEffect();
+
+    printf("  effect %-7u %10.1f ns/tick %12.0f frames/s\n", index, elapsed / EFFECT_TICKS,
+           EFFECT_TICKS * 1e9 / elapsed);
+}
+
+// ---------------------------------------------------------------------------------------
+// Serial link
+// ---------------------------------------------------------------------------------------
+
+// Frame rate the serial line allows for a frame encoded into the given number of bytes
+static void printLink(const char *name, size_t bytes)
+{
+    printf("  %-14s %6zu bytes/frame %8.1f frames/s @ %u baud\n", name, bytes,
+           SERIAL_BYTES_PER_SECOND(BAUD_RATE) / bytes, BAUD_RATE);
+}
+
+static void runSerialLink()
+{
+    uint8_t frame[FRAME_SIZE];
+    uint8_t encoded[ENCODED_PACKET_SIZE(FRAME_SIZE)];
+    uint8_t text[LAYER_COUNT * (LAYER_SIZE + 6)];
+    size_t length;
+    unsigned long i;
+    unsigned long frames = 0;
+    double start;
+    double elapsed;
+
+    for (i = 0; i < FRAME_SIZE; ++i) {
+        frame[i] = rand();
+    }
+    printLink("text RAW", encodeRawText(frame, LAYER_COUNT, LAYER_SIZE, text));
+    length = encodePacket(PACKET_FRAME, 0, frame, FRAME_SIZE, encoded);
+    printLink("binary", length);
+
+    start = now();
+    for (i = 0; i < DECODE_FRAMES; ++i) {
+        encoded[length-2] ^= i & 1;     // alternate between a valid and an invalid CRC
+        protocolReset();                // the same sequence number every time
+        latchFrame();
+        for (size_t j = 0; j < length; ++j) {
+            if (protocolReceive(encoded[j]) == PROTOCOL_FRAME) {
+                ++frames;
+            }
+        }
+    }
+    elapsed = now() - start;
+    consume();
+    printf("  %-14s %10.1f ns/frame (%lu of %lu accepted)\n", "decode", elapsed / DECODE_FRAMES,
+           frames, DECODE_FRAMES);
+}
+
+// Record RECORD_FRAMES frames of an effect, every one of them from its own tick
+static void recordEffect(uint8_t index)
+{
+    unsigned i;
+
+    seedRandom(1);
+    startEffect(index);
+    for (i = 0; i < RECORD_FRAMES; ++i) {
+        processEffect(false, EFFECT_TICK_FRAMES);
+        if (isEffectFinished()) {
+            startEffect(index);
+        }
+        memcpy(recorded[i], cubeBuffer[presentedBuffer][0], FRAME_SIZE);
+    }
+    forceFinishEffect();
+}
+
+// Record the frames of an effect, send them through the compressed binary protocol and
+// check that the decoder reproduces every frame
+static bool runCompression(uint8_t index)
+{
+    uint8_t encoded[ENCODED_PACKET_SIZE(2 * FRAME_SIZE)];
+    uint8_t text[LAYER_COUNT * (LAYER_SIZE + 6)];
+    uint8_t type;
+    unsigned long textBytes = 0;
+    unsigned long frameBytes = 0;
+    unsigned long compressedBytes = 0;
+    unsigned long counts[3] = { 0, 0, 0 };
+    unsigned i;
+    unsigned failures = 0;
+
+    recordEffect(index);
+
+    protocolReset();
+    latchFrame();
+    for (i = 0; i < RECORD_FRAMES; ++i) {
+        size_t length = encodeFrame(i, i ? recorded[i-1] : NULL, recorded[i], FRAME_SIZE, encoded, &type);
+        uint8_t result = PROTOCOL_BUSY;
+
+        for (size_t j = 0; j < length; ++j) {
+            result = protocolReceive(encoded[j]);
+        }
+        if (result != PROTOCOL_FRAME || memcmp(cubeBuffer[presentedBuffer][0], recorded[i], FRAME_SIZE)) {
+            ++failures;
+        }
+        latchFrame();                   // the display ISR picks up every frame
+
+        textBytes += encodeRawText(recorded[i], LAYER_COUNT, LAYER_SIZE, text);
+        frameBytes += encodePacket(PACKET_FRAME, i, recorded[i], FRAME_SIZE, encoded);
+        compressedBytes += length;
+        ++counts[type == PACKET_FRAME ? 0 : type == PACKET_RLE ? 1 : 2];
+    }
+
+    printf("  effect %-3u %5.1f B/frame (full %5.1f, text %5.1f) ratio %4.2f %7.1f frames/s  F/K/D %lu/%lu/%lu %s\n",
+           index, (double)compressedBytes / RECORD_FRAMES, (double)frameBytes / RECORD_FRAMES,
+           (double)textBytes / RECORD_FRAMES, (double)compressedBytes / frameBytes,
+           SERIAL_BYTES_PER_SECOND(BAUD_RATE) * RECORD_FRAMES / compressedBytes,
+           counts[0], counts[1], counts[2], failures ? "ROUND TRIP FAILED" : "round trip ok");
+    return failures == 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Animation container
+// ---------------------------------------------------------------------------------------
+
+// Store the frames of an effect in an animation container and play it back
+static bool runAnimation(uint8_t index)
+{
+    static uint8_t container[ANIMATION_HEADER_SIZE + RECORD_FRAMES * (FRAME_SIZE + FRAME_SIZE / 128 + 3)];
+    size_t length;
+    unsigned long keyframes = 0;
+    unsigned i;
+    unsigned j;
+    unsigned failures = 0;
+    double start;
+    double elapsed;
+
+    recordEffect(index);
+    length = encodeAnimation(recorded[0], RECORD_FRAMES, LAYER_COUNT, FRAME_SIZE, container);
+
+    // round trip: the frames with the same content in a row are merged
+    animationOpen(ANIMATION_FLASH, container);
+    for (i = 0; i < RECORD_FRAMES; ) {
+        uint8_t duration = animationNextFrame();
+        if (duration == 0) {
+            ++failures;
+            break;
+        }
+        for (j = 0; j < duration && i < RECORD_FRAMES; ++j, ++i) {
+            if (memcmp(cube, recorded[i], FRAME_SIZE)) {
+                ++failures;
+            }
+        }
+    }
+
+    start = now();
+    for (j = 0; j < 20; ++j) {
+        animationRewind();
+        for (i = 0; animationNextFrame(); ++i) {
+        }
+    }
+    elapsed = now() - start;
+    consume();
+    for (i = ANIMATION_HEADER_SIZE; i < length; ) {
+        // skip the frames to count the keyframes (frame: flags, duration, PackBits data)
+        size_t remaining = FRAME_SIZE;
+        keyframes += !(container[i] & ANIMATION_DELTA);
+        i += 2;
+        while (remaining) {
+            uint8_t count = (container[i] & 0x7F) + 1;
+            i += (container[i] & 0x80) ? 2 : count + 1;
+            remaining -= count;
+        }
+    }
+
+    printf("  effect %-3u %5.1f B/frame (%u frames in %u, %lu keyframes) %7.1f ns/frame decode  %s\n",
+           index, (double)length / RECORD_FRAMES, container[2] | (container[3] << 8), RECORD_FRAMES,
+           keyframes, elapsed / (20.0 * (container[2] | (container[3] << 8))),
+           failures ? "ROUND TRIP FAILED" : "round trip ok");
+    return failures == 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Animation upload
+// ---------------------------------------------------------------------------------------
+
+static unsigned long eepromWrites;
+
+// Let the EEPROM finish a write and run its ready interrupt
+static void eepromStep()
+{
+    if (EECR & (1<<EEWE)) {
+        hostEepromWriteDone();
+        ++eepromWrites;
+    }
+    if (EECR & (1<<EERIE)) {
+        EE_RDY_vect();
+    }
+}
+
+// Send a BLOCK command to the upload (See upload.h), corrupt: flip a data bit
+static uint8_t sendBlock(const uint8_t *animation, uint16_t size, uint16_t index, bool corrupt)
+{
+    uint8_t crc = 0;
+    uint8_t i;
+
+    memset(uploadBuffer, 0x00, sizeof(uploadBuffer));
+    uploadBuffer[0] = index & 0xFF;
+    uploadBuffer[1] = index >> 8;
+    for (i = 0; i < UPLOAD_BLOCK_SIZE && index * UPLOAD_BLOCK_SIZE + i < size; ++i) {
+        uploadBuffer[2 + i] = animation[index * UPLOAD_BLOCK_SIZE + i];
+    }
+    for (i = 0; i < BLOCK_ARGUMENTS_SIZE - 1; ++i) {
+        crc = _crc_ibutton_update(crc, uploadBuffer[i]);
+    }
+    uploadBuffer[BLOCK_ARGUMENTS_SIZE - 1] = crc;
+    if (corrupt) {
+        uploadBuffer[2] ^= 0x10;
+    }
+    return uploadBlock();
+}
+
+// Send an UPLOAD command, the BLOCKs are dropped until the record is written
+static uint16_t sendUpload(const uint8_t *animation, uint16_t size)
+{
+    uint16_t crc = 0xFFFF;
+    uint16_t block;
+    uint16_t i;
+
+    for (i = 0; i < size; ++i) {
+        crc = _crc16_update(crc, animation[i]);
+    }
+    uploadBuffer[0] = size & 0xFF;
+    uploadBuffer[1] = size >> 8;
+    uploadBuffer[2] = crc & 0xFF;
+    uploadBuffer[3] = crc >> 8;
+    block = uploadStart();
+    while (uploadBusy()) {
+        eepromStep();
+        uploadPoll();
+    }
+    return block;
+}
+
+// Upload a recorded effect into the EEPROM block by block. The link drops in the middle
+// of the upload and resets the cube, a block gets corrupted and an ACK gets lost: the
+// upload is resumed from the record in the EEPROM and the animation has to play back
+// from the EEPROM afterwards.
+static bool runUpload(uint8_t index)
+{
+    static uint8_t container[ANIMATION_HEADER_SIZE + RECORD_FRAMES * (FRAME_SIZE + FRAME_SIZE / 128 + 3)];
+    size_t length;
+    unsigned frames = RECORD_FRAMES;
+    uint16_t blocks;
+    uint16_t block;
+    uint16_t resumed = 0;
+    uint8_t result = UPLOAD_IDLE;
+    unsigned long naks = 0;
+    bool invalidated = true;
+    bool ok;
+
+    recordEffect(index);
+    while ((length = encodeAnimation(recorded[0], frames, LAYER_COUNT, FRAME_SIZE, container)) > UPLOAD_SPACE) {
+        frames /= 2;
+    }
+    blocks = (length + UPLOAD_BLOCK_SIZE - 1) / UPLOAD_BLOCK_SIZE;
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    eepromWrites = 0;
+
+    block = sendUpload(container, length);
+    while (block < blocks && block != UPLOAD_INVALID) {
+        if (block == blocks / 2 && !resumed) {
+            // the link drops and resets the cube: the host starts over with UPLOAD and
+            // continues, the RAM of the upload is gone
+            uploadInit();
+            resumed = block = sendUpload(container, length);
+            continue;
+        }
+        if (block == blocks / 3 && sendBlock(container, length, block, true) == BLOCK_NAK) {
+            ++naks;
+        }
+        if (sendBlock(container, length, block, false) != BLOCK_WRITING) {
+            break;
+        }
+        while ((result = uploadPoll()) == UPLOAD_IDLE) {
+            eepromStep();
+        }
+        if (result != UPLOAD_ACK) {
+            break;
+        }
+        // a lost ACK: the host sends the block again
+        if (block == 1 && sendBlock(container, length, block, false) != BLOCK_ACK) {
+            break;
+        }
+        invalidated &= !animationOpen(ANIMATION_EEPROM, 0);
+        block = uploadWrittenBlocks();
+    }
+    // the CRC check and the first byte follow the last block
+    while (result == UPLOAD_ACK || result == UPLOAD_IDLE) {
+        eepromStep();
+        result = uploadPoll();
+    }
+
+    ok = result == UPLOAD_DONE && invalidated && resumed == blocks / 2 &&
+         !memcmp(hostEeprom, container, length) &&
+         animationOpen(ANIMATION_EEPROM, 0);
+    frames = container[2] | (container[3] << 8);
+    while (ok && frames--) {
+        ok = animationNextFrame() != 0;
+    }
+    printf("  effect %-3u %4u bytes, %3u blocks, %u NAK, resumed at %3u, %5.2f s EEPROM, %5.2f s link  %s\n",
+           index, (unsigned)length, blocks, (unsigned)naks, resumed, eepromWrites * EEPROM_WRITE_MS / 1000,
+           (double)blocks * (5 + BLOCK_ARGUMENTS_SIZE + 2) / SERIAL_BYTES_PER_SECOND(BAUD_RATE),
+           ok ? "playback ok" : "UPLOAD FAILED");
+    return ok;
+}
+
+// ---------------------------------------------------------------------------------------
+// Flow control
+// ---------------------------------------------------------------------------------------
+// Streams a recorded effect through the binary protocol over a simulated serial line
+// (Timer1 ticks). The cube follows processSerialInput() in LEDcube.ino, including the
+// UART ring buffer, the replies blocking the main loop while they are sent and a main
+// loop stalling now and then. The host keeps to the credits, goes back on a NAK and
+// resends after a timeout. Every frame has to be shown, once and in order.
+
+struct SimulatedCube {
+    uint8_t rx[UART_RX_BUFFER_SIZE];
+    uint8_t rxHead;
+    uint8_t rxCount;
+    uint8_t tx[256];            // replies on the line to the host
+    uint8_t txHead;
+    uint8_t txCount;
+    unsigned long busyUntil;    // uartWrite() waits for the transmitter
+    unsigned long overruns;     // bytes lost, the ring buffer was full
+};
+
+struct SimulatedHost {
+    unsigned count;             // frames of the stream
+    unsigned next;              // frame sent next
+    unsigned sent;              // frames sent so far (highest + 1)
+    long acked;                 // last frame accepted by the cube
+    long limit;                 // last frame the credits allow
+    bool keyframe;              // the next frame must not be a delta
+    unsigned long lastReply;    // or the end of the last packet, whatever is later
+    uint8_t packet[ENCODED_PACKET_SIZE(2 * FRAME_SIZE)];
+    size_t length;
+    size_t position;
+    uint8_t reply[16];
+    uint8_t replyLength;
+    unsigned long naks;
+    unsigned long timeouts;
+    unsigned long bytes;
+    uint16_t clock;             // last PACKET_CLOCK reply ...
+    unsigned long clockTime;    // ... and its arrival
+};
+
+static void cubeReply(SimulatedCube *c, uint8_t type, unsigned long time)
+{
+    uint8_t packet[REPLY_PACKET_SIZE];
+    uint8_t length = protocolReply(type, packet);
+    uint8_t i;
+
+    for (i = 0; i < length; ++i) {
+        c->tx[(uint8_t)(c->txHead + c->txCount++)] = packet[i];
+    }
+    c->busyUntil = time + length * BYTE_TICKS;
+}
+
+// processSerialInput() in binary mode. Returns after a reply, the main loop waits for it.
+static void cubeLoop(SimulatedCube *c, unsigned long time)
+{
+    uint8_t result = protocolPoll();
+
+    if (result == PROTOCOL_CREDIT) {
+        cubeReply(c, PACKET_ACK, time);
+        return;
+    } else if (result == PROTOCOL_WAIT) {
+        return;
+    }
+    while (c->rxCount) {
+        uint8_t data = c->rx[c->rxHead];
+        c->rxHead = (c->rxHead + 1) % UART_RX_BUFFER_SIZE;
+        --c->rxCount;
+        result = protocolReceive(data);
+        if (result == PROTOCOL_FRAME || result == PROTOCOL_DUPLICATE) {
+            cubeReply(c, PACKET_ACK, time);
+            return;
+        } else if (result == PROTOCOL_ERROR) {
+            cubeReply(c, PACKET_NAK, time);
+            return;
+        } else if (result == PROTOCOL_CLOCK) {
+            cubeReply(c, PACKET_CLOCK, time);
+            return;
+        }
+    }
+}
+
+// Absolute frame number of a sequence number at most 255 frames before frame
+static long frameOf(long frame, uint8_t sequence)
+{
+    return frame - (uint8_t)(frame - sequence);
+}
+
+static void hostReceive(SimulatedHost *h, uint8_t data, unsigned long time)
+{
+    uint8_t content[sizeof(h->reply)];
+    long frame;
+
+    if (data != 0x00) {
+        if (h->replyLength < sizeof(h->reply)) {
+            h->reply[h->replyLength++] = data;
+        }
+        return;
+    }
+    if (decodePacket(h->reply, h->replyLength, content) == 4 && content[0] == PACKET_CLOCK) {
+        h->clock = content[2] | (content[3] << 8);
+        h->clockTime = time;
+    } else if (decodePacket(h->reply, h->replyLength, content) == 3) {
+        h->lastReply = time;
+        if (content[0] == PACKET_ACK) {
+            frame = frameOf(h->sent - 1, content[1]);
+            if (frame >= h->acked) {
+                h->acked = frame;
+                h->limit = frame + content[2];
+                if ((long)h->next <= frame) {
+                    h->next = frame + 1;        // a resent frame has been accepted before
+                }
+            }
+        } else if (content[0] == PACKET_NAK) {
+            frame = frameOf(h->sent, content[1]);
+            if (frame > h->acked) {
+                h->acked = frame - 1;
+                h->limit = frame - 1 + content[2];
+                h->next = frame;
+                h->keyframe = true;
+                ++h->naks;
+            }
+        }
+    }
+    h->replyLength = 0;
+}
+
+// Transfer a byte in both directions, errorRate: one byte in errorRate gets a flipped
+// bit (0: none)
+static void transferBytes(SimulatedCube *c, SimulatedHost *h, unsigned long time, unsigned errorRate)
+{
+    if (h->position < h->length) {
+        uint8_t data = h->packet[h->position++];
+        if (errorRate && rand() % errorRate == 0) {
+            data ^= 1 << (rand() % 8);
+        }
+        ++h->bytes;
+        if (h->position == h->length) {
+            h->lastReply = time;
+        }
+        if (c->rxCount < UART_RX_BUFFER_SIZE) {
+            c->rx[(c->rxHead + c->rxCount++) % UART_RX_BUFFER_SIZE] = data;
+        } else {
+            ++c->overruns;
+        }
+    }
+    if (c->txCount) {
+        uint8_t data = c->tx[c->txHead++];
+        --c->txCount;
+        if (errorRate && rand() % errorRate == 0) {
+            data ^= 1 << (rand() % 8);
+        }
+        hostReceive(h, data, time);
+    }
+}
+
+// Run the main loop of the cube unless it is busy
+static void cubeStep(SimulatedCube *c, unsigned long time)
+{
+    if (time >= c->busyUntil && time % STALL_INTERVAL >= STALL_TICKS) {
+        cubeLoop(c, time);
+    }
+}
+
+static void resetSimulation(SimulatedCube *c, SimulatedHost *h, unsigned count)
+{
+    memset(c, 0, sizeof(*c));
+    memset(h, 0, sizeof(*h));
+    h->count = count;
+    h->acked = -1;
+    h->limit = PROTOCOL_WINDOW - 1;
+    h->keyframe = true;
+    protocolReset();
+    latchFrame();
+}
+
+// Stream the recorded frames, errorRate: one byte in errorRate gets a flipped bit (0: none)
+static bool runFlowControl(uint8_t index, unsigned errorRate)
+{
+    static SimulatedCube c;
+    static SimulatedHost h;
+    unsigned long time = 0;
+    unsigned long nextRefresh = REFRESH_TICKS;
+    unsigned shown = 0;
+    unsigned wrong = 0;
+    uint8_t type;
+
+    recordEffect(index);
+    resetSimulation(&c, &h, RECORD_FRAMES);
+    srand(index + errorRate);
+
+    while (shown < h.count && time < STREAM_LIMIT) {
+        time += BYTE_TICKS;
+
+        // host -> cube
+        if (h.position == h.length && h.next < h.count && (long)h.next <= h.limit) {
+            h.length = encodeFrame(h.next & 0xFF, h.keyframe || h.next == 0 ? NULL : recorded[h.next - 1],
+                                   recorded[h.next], FRAME_SIZE, h.packet, &type);
+            h.position = 0;
+            h.keyframe = false;
+            if (++h.next > h.sent) {
+                h.sent = h.next;
+            }
+        }
+        transferBytes(&c, &h, time, errorRate);
+        if ((long)h.next > h.acked + 1 && h.position == h.length && time - h.lastReply > STREAM_TIMEOUT) {
+            h.next = h.acked + 1;
+            h.keyframe = true;
+            h.lastReply = time;
+            ++h.timeouts;
+        }
+
+        // display ISR: every presented frame is shown from the next refresh on
+        while (time >= nextRefresh) {
+            if (pendingBuffer != NO_BUFFER) {
+                if (shown < h.count && memcmp(cubeBuffer[pendingBuffer][0], recorded[shown], FRAME_SIZE)) {
+                    ++wrong;
+                }
+                ++shown;
+            }
+            latchFrame();
+            nextRefresh += REFRESH_TICKS;
+        }
+        cubeStep(&c, time);
+    }
+
+    bool ok = shown == h.count && wrong == 0 && c.overruns == 0;
+    printf("  effect %-3u %-5s %7.1f frames/s, link %3.0f%% busy, %4lu NAK, %3lu timeouts, %lu overruns  %s\n",
+           index, errorRate ? "noisy" : "clean", shown * (F_CPU / 8.0) / time,
+           100.0 * h.bytes * BYTE_TICKS / time, h.naks, h.timeouts, c.overruns,
+           ok ? "all shown in order" : "STREAM FAILED");
+    return ok;
+}
+
+// ---------------------------------------------------------------------------------------
+// Timed frame ahead
+// ---------------------------------------------------------------------------------------
+// A timed frame is due AHEAD_REFRESHES ahead, an untimed frame and a clock request
+// follow it. The link has to go on while the timed frame waits for its refresh: the
+// untimed frame is ACKed and shown after the timed one, the clock request is answered.
+
+#define AHEAD_REFRESHES 2000    // 1.7 s
+
+static bool runTimedAhead()
+{
+    static SimulatedCube c;
+    static SimulatedHost h;
+    unsigned long time = 0;
+    unsigned long nextRefresh = REFRESH_TICKS;
+    unsigned long refreshes = 0;
+    unsigned long acked = 0;    // time the untimed frame has been ACKed
+    unsigned long clock = 0;    // time the clock request has been answered
+    unsigned shown = 0;
+    unsigned wrong = 0;
+    uint16_t due;
+    uint8_t type;
+
+    recordEffect(0);
+    resetSimulation(&c, &h, 2);
+    due = refreshClock + AHEAD_REFRESHES;
+
+    while (shown < h.count && refreshes < 2 * AHEAD_REFRESHES) {
+        time += BYTE_TICKS;
+
+        // host -> cube: the timed frame, the untimed frame, the clock request
+        if (h.position == h.length && h.next <= h.count) {
+            if (h.next == 0) {
+                h.length = encodeTimedFrame(0, due, NULL, recorded[0], FRAME_SIZE, h.packet, &type);
+                h.sent = 1;
+            } else if (h.next == 1) {
+                h.length = encodeFrame(1, recorded[0], recorded[1], FRAME_SIZE, h.packet, &type);
+                h.sent = 2;
+            } else {
+                h.length = encodePacket(PACKET_CLOCK, 0, NULL, 0, h.packet);
+            }
+            h.position = 0;
+            ++h.next;
+        }
+        transferBytes(&c, &h, time, 0);
+        if (!acked && h.acked == 1) {
+            acked = time;
+        }
+        if (!clock && h.clockTime) {
+            clock = time;
+        }
+
+        // display ISR
+        while (time >= nextRefresh) {
+            uint8_t pending = pendingBuffer;
+            latchFrame();
+            if (pending != NO_BUFFER && pendingBuffer == NO_BUFFER) {
+                if (shown < h.count && memcmp(cubeBuffer[pending][0], recorded[shown], FRAME_SIZE)) {
+                    ++wrong;
+                }
+                ++shown;
+            }
+            ++refreshes;
+            nextRefresh += REFRESH_TICKS;
+        }
+        cubeStep(&c, time);
+    }
+
+    double ahead = AHEAD_REFRESHES * REFRESH_TICKS / (F_CPU / 8.0);
+    bool ok = shown == h.count && wrong == 0 && c.overruns == 0 && acked && clock &&
+              acked / (F_CPU / 8.0) < ahead && clock / (F_CPU / 8.0) < ahead;
+    printf("  timed frame %.2f s ahead: untimed frame ACKed after %.2f ms, clock after %.2f ms  %s\n",
+           ahead, acked * 1000 / (F_CPU / 8.0), clock * 1000 / (F_CPU / 8.0),
+           ok ? "link kept going" : "LINK STALLED");
+    return ok;
+}
+
+// ---------------------------------------------------------------------------------------
+// Scheduled presentation
+// ---------------------------------------------------------------------------------------
+// The host plays the recorded frames along a timeline (synced to music, say), every
+// packet leaves up to SEND_JITTER late. Untimed frames are shown when they arrive, timed
+// ones are sent PRESENT_LEAD ahead and wait in the frame queue for their refresh. The
+// host maps its timeline onto the cube clock with PACKET_CLOCK, although its own clock
+// drifts. Measured: when every frame is shown, relative to its time on the timeline.
+
+// Cube clock seen from the host: refresh `clock` started half a refresh before `host`
+struct ClockMapping {
+    double host;
+    long clock;
+    double rate;                // refreshes per host second
+};
+
+static double hostSeconds(unsigned long time)
+{
+    return time / (F_CPU / 8.0) * (1 + HOST_DRIFT) + HOST_OFFSET;
+}
+
+// Refresh (cube clock) starting closest to a host time
+static long refreshAt(const ClockMapping *mapping, double host)
+{
+    return lround(mapping->clock + 0.5 + (host - mapping->host) * mapping->rate);
+}
+
+static bool runPresentation(uint8_t index, bool timed)
+{
+    static SimulatedCube c;
+    static SimulatedHost h;
+    static double sendJitter[PLAY_FRAMES];
+    ClockMapping first = {0, 0, 0};
+    ClockMapping mapping = {0, 0, 1 / REFRESH_SECONDS};
+    ClockMapping best = {0, 0, 0};
+    unsigned long time = 0;
+    unsigned long nextRefresh = REFRESH_TICKS;
+    double requestSent = 0;
+    double bestRoundTrip = 0;
+    double nextSync = 0;
+    double start = 0;           // host time of the first frame, set after the first sync
+    uint8_t samples = 0;
+    uint8_t syncs = 0;
+    bool requestPending = false;
+    unsigned shown = 0;
+    unsigned wrong = 0;
+    double sum = 0;
+    double sumSquares = 0;
+    double minError = 1e9;
+    double maxError = -1e9;
+    unsigned i;
+    uint8_t type;
+
+    recordEffect(index);
+    resetSimulation(&c, &h, PLAY_FRAMES);
+    srand(index);
+    for (i = 0; i < PLAY_FRAMES; ++i) {
+        sendJitter[i] = SEND_JITTER * rand() / RAND_MAX;
+    }
+
+    while (shown < h.count && time < STREAM_LIMIT) {
+        double now = hostSeconds(time += BYTE_TICKS);
+
+        // clock replies: the one with the shortest round trip of a sync counts
+        if (h.clockTime) {
+            double arrival = hostSeconds(h.clockTime) + RECEIVE_JITTER * rand() / RAND_MAX;
+            long clock = syncs ? mapping.clock + (int16_t)(h.clock - (uint16_t)mapping.clock) : h.clock;
+
+            // the cube took the sample after the request and before the reply was sent
+            if (samples == 0 || arrival - requestSent < bestRoundTrip) {
+                bestRoundTrip = arrival - requestSent;
+                best.host = (requestSent + arrival - REPLY_PACKET_SIZE * BYTE_SECONDS) / 2;
+                best.clock = clock;
+            }
+            h.clockTime = 0;
+            requestPending = false;
+            if (++samples == SYNC_SAMPLES) {
+                if (syncs++ == 0) {
+                    first = best;
+                    start = now + 2 * PRESENT_LEAD;
+                } else {
+                    mapping.rate = (best.clock - first.clock) / (best.host - first.host);
+                }
+                mapping.host = best.host;
+                mapping.clock = best.clock;
+                samples = 0;
+                nextSync = now + SYNC_INTERVAL;
+            }
+        }
+
+        // host -> cube: clock requests while syncing, the frames along the timeline
+        if (h.position == h.length) {
+            if (now >= nextSync) {
+                if (!requestPending) {
+                    h.length = encodePacket(PACKET_CLOCK, 0, NULL, 0, h.packet);
+                    h.position = 0;
+                    requestSent = now + h.length * BYTE_SECONDS;
+                    requestPending = true;
+                }
+            } else if (syncs && h.next < h.count && (long)h.next <= h.limit) {
+                double due = start + h.next * PLAY_INTERVAL;
+                if (now >= due - (timed ? PRESENT_LEAD : 0) + sendJitter[h.next]) {
+                    const uint8_t *previous = h.next ? recorded[h.next - 1] : NULL;
+                    if (timed) {
+                        h.length = encodeTimedFrame(h.next & 0xFF, refreshAt(&mapping, due), previous,
+                                                    recorded[h.next], FRAME_SIZE, h.packet, &type);
+                    } else {
+                        h.length = encodeFrame(h.next & 0xFF, previous, recorded[h.next], FRAME_SIZE,
+                                               h.packet, &type);
+                    }
+                    h.position = 0;
+                    h.sent = ++h.next;
+                }
+            }
+        }
+        transferBytes(&c, &h, time, 0);
+
+        // display ISR: measure when the frames are shown
+        while (time >= nextRefresh) {
+            uint8_t pending = pendingBuffer;
+            latchFrame();
+            if (pending != NO_BUFFER && pendingBuffer == NO_BUFFER && shown < h.count) {
+                double error = hostSeconds(nextRefresh) - (start + shown * PLAY_INTERVAL);
+                if (memcmp(cubeBuffer[pending][0], recorded[shown], FRAME_SIZE)) {
+                    ++wrong;
+                }
+                sum += error;
+                sumSquares += error * error;
+                minError = error < minError ? error : minError;
+                maxError = error > maxError ? error : maxError;
+                ++shown;
+            }
+            nextRefresh += REFRESH_TICKS;
+        }
+        cubeStep(&c, time);
+    }
+
+    double mean = sum / shown;
+    double deviation = sqrt(sumSquares / shown - mean * mean);
+    bool ok = shown == h.count && wrong == 0 && (!timed || maxError - minError < 3 * REFRESH_SECONDS);
+    printf("  %-7s latency %6.2f ms, jitter %5.2f ms rms, %5.2f ms peak-to-peak  %s\n",
+           timed ? "timed" : "untimed", mean * 1000, deviation * 1000, (maxError - minError) * 1000,
+           ok ? "all shown in order" : "PRESENTATION FAILED");
+    return ok;
+}
+
+// ---------------------------------------------------------------------------------------
+// Frame scheduler
+// ---------------------------------------------------------------------------------------
+
+// Simulates the display ISR and a main loop on the Timer1 time base. Rendering a frame
+// takes one refresh, every SLOW_FRAME_INTERVAL-th frame takes SLOW_FRAME_TICKS.
+static void runScheduler()
+{
+    unsigned long time = 0;             // Timer1 ticks
+    unsigned long busyUntil = 0;
+    unsigned long rendered = 0;
+    unsigned long advanced = 0;
+    unsigned long lateness;
+    unsigned long maxLateness = 0;
+    double sumLateness = 0;
+    uint16_t overruns = getFrameOverruns();
+
+    dueFrames = 0;
+    frameTime = 0;
+    while (time < SCHEDULE_SECONDS * (F_CPU / 8)) {
+        time += REFRESH_TICKS;
+        schedulerTick(REFRESH_TICKS);
+        if (time < busyUntil) {
+            continue;
+        }
+        uint8_t frames = takeFrames();
+        if (!frames) {
+            continue;
+        }
+        // the latest of the taken frames fell due frameTime ticks ago at most
+        lateness = time - (advanced + frames) * TICKS_PER_FRAME;
+        if (lateness > maxLateness) {
+            maxLateness = lateness;
+        }
+        sumLateness += lateness;
+        advanced += frames;
+        busyUntil = time + (++rendered % SLOW_FRAME_INTERVAL ? REFRESH_TICKS : SLOW_FRAME_TICKS);
+    }
+    printf("  %s policy, %u fps: %lu frames in %u s, %lu rendered, %u overruns\n",
+           SCHEDULE_POLICY == SCHEDULE_SKIP ? "skip" : "catch-up", FRAME_RATE, advanced,
+           SCHEDULE_SECONDS, rendered, getFrameOverruns() - overruns);
+    printf("  frame start lateness: mean %.0f us, max %.0f us\n",
+           sumLateness / rendered * 8e6 / F_CPU, maxLateness * 8e6 / F_CPU);
+}
+
+// ---------------------------------------------------------------------------------------
+// Reference checks
+// ---------------------------------------------------------------------------------------
+// The row and byte code of cube.h compared with the voxel by voxel definition of what it
+// does, on random frames of all densities. getVoxel() and alterVoxel() are the reference.
+
+#define TRANSFORM_SHIFT     0
+#define TRANSFORM_ROTATE    1
+#define TRANSFORM_ROTATE90  2
+#define TRANSFORM_MIRROR    3
+#define TRANSFORM_TRANSPOSE 4
+#define TRANSFORM_TYPES     5
+
+static const char *transformNames[TRANSFORM_TYPES] = {
+    "shift", "rotate", "rotate90", "mirror", "transpose"
+};
+static const char axisNames[] = "?XYZ";
+
+static uint8_t referenceFrame[LAYER_COUNT][LAYER_COUNT][LAYER_COUNT];   // [z][y][x]
+
+// Fill the back buffer with random voxels and keep a copy of them in referenceFrame
+static void randomFrame(uint16_t seed)
+{
+    uint8_t x, y, z;
+
+    seedRandom(seed);
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        randomSparseLayer(z, (uint8_t)(seed * 53));
+    }
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                referenceFrame[z][y][x] = getVoxel(x, y, z);
+            }
+        }
+    }
+}
+
+static void applyTransform(uint8_t type, uint8_t axis, int8_t direction)
+{
+    switch (type) {
+    case TRANSFORM_SHIFT:
+        shift(axis, direction);
+        break;
+    case TRANSFORM_ROTATE:
+        rotate(axis, direction);
+        break;
+    case TRANSFORM_ROTATE90:
+        rotate90(axis, direction);
+        break;
+    case TRANSFORM_MIRROR:
+        mirror(axis);
+        break;
+    case TRANSFORM_TRANSPOSE:
+        transpose(axis);
+        break;
+    }
+}
+
+// Mirror and transpose have no direction
+static bool transformHasDirection(uint8_t type)
+{
+    return type != TRANSFORM_MIRROR && type != TRANSFORM_TRANSPOSE;
+}
+
+// Turns the coordinates c (x, y, z) of a voxel after the transform into the ones it
+// had before. Returns false if the voxel comes from outside the cube (it is off).
+// The axes perpendicular to an axis (u, v) are the next two in the order x, y, z, x, y, so
+// that u, v and the axis form a right-handed system. Seen from the positive end of the
+// axis, a counterclockwise quarter turn moves (u, v) to (N-1-v, u).
+static bool transformSource(uint8_t type, uint8_t axis, int8_t direction, int8_t *c)
+{
+    int8_t *a = &c[axis - 1];
+    int8_t *u = &c[axis % 3];
+    int8_t *v = &c[(axis + 1) % 3];
+    int8_t t;
+
+    switch (type) {
+    case TRANSFORM_SHIFT:
+        *a -= direction;
+        return *a >= 0 && *a < LAYER_COUNT;
+    case TRANSFORM_ROTATE:
+        *a = (*a - direction + LAYER_COUNT) % LAYER_COUNT;
+        return true;
+    case TRANSFORM_ROTATE90:
+        t = *u;
+        if (direction > 0) {
+            *u = *v;
+            *v = LAYER_COUNT - 1 - t;
+        } else {
+            *u = LAYER_COUNT - 1 - *v;
+            *v = t;
+        }
+        return true;
+    case TRANSFORM_MIRROR:
+        *a = LAYER_COUNT - 1 - *a;
+        return true;
+    case TRANSFORM_TRANSPOSE:
+        t = *u;
+        *u = *v;
+        *v = t;
+        return true;
+    }
+    return false;
+}
+
+// Voxels of the back buffer which differ from the transformed referenceFrame
+static unsigned long transformErrors(uint8_t type, uint8_t axis, int8_t direction)
+{
+    unsigned long errors = 0;
+    uint8_t x, y, z;
+    uint8_t expected;
+    int8_t c[3];
+
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                c[0] = x;
+                c[1] = y;
+                c[2] = z;
+                expected = transformSource(type, axis, direction, c) ? referenceFrame[c[2]][c[1]][c[0]] : 0;
+                errors += getVoxel(x, y, z) != expected;
+            }
+        }
+    }
+    return errors;
+}
+
+// Every transform on every axis in both directions, CHECK_FRAMES random frames each
+static bool runTransforms()
+{
+    static const int8_t directions[2] = { -1, 1 };
+    unsigned long frames;
+    unsigned long failures;
+    unsigned long errors;
+    uint8_t type;
+    uint8_t axis;
+    uint8_t d;
+    uint16_t seed;
+    bool ok = true;
+
+    for (type = 0; type < TRANSFORM_TYPES; ++type) {
+        frames = 0;
+        failures = 0;
+        for (axis = AXIS_X; axis <= AXIS_Z; ++axis) {
+            for (d = transformHasDirection(type) ? 0 : 1; d < 2; ++d) {
+                for (seed = 1; seed <= CHECK_FRAMES; ++seed, ++frames) {
+                    randomFrame(seed);
+                    applyTransform(type, axis, directions[d]);
+                    errors = transformErrors(type, axis, directions[d]);
+                    if (errors && !failures++) {
+                        printf("  %s %c %+d: %lu voxels differ from seed %u on\n", transformNames[type],
+                               axisNames[axis], directions[d], errors, seed);
+                    }
+                }
+            }
+        }
+        printf("  %-10s %5lu frames, %lu differ%s\n", transformNames[type], frames, failures,
+               failures ? "  FAILED" : "");
+        ok &= failures == 0;
+    }
+    return ok;
+}
+
+// Random sprites of every size (rows with unused bits set) at random positions, partly or
+// completely outside of the cube, with all four operations
+static bool runBlit()
+{
+    static const char *opNames[4] = { "or", "and", "xor", "mask" };
+    static uint8_t data[LAYER_COUNT * LAYER_COUNT * SPRITE_ROW_BYTES(LAYER_COUNT)];
+    Sprite sprite = { 0, 0, 0, data };
+    unsigned long frames = 0;
+    unsigned long failures = 0;
+    unsigned long errors;
+    uint16_t seed;
+    uint16_t i;
+    uint8_t rowBytes;
+    uint8_t op;
+    uint8_t x, y, z;
+    uint8_t expected;
+    int8_t px, py, pz;
+    int8_t sx, sy, sz;
+    bool inside;
+    bool bit;
+
+    for (seed = 1; seed <= CHECK_FRAMES; ++seed) {
+        for (op = BLIT_OR; op <= BLIT_MASK; ++op, ++frames) {
+            randomFrame(seed * 4 + op);
+            sprite.sizeX = 1 + randomWord() % LAYER_COUNT;
+            sprite.sizeY = 1 + randomWord() % LAYER_COUNT;
+            sprite.sizeZ = 1 + randomWord() % LAYER_COUNT;
+            rowBytes = SPRITE_ROW_BYTES(sprite.sizeX);
+            for (i = 0; i < sizeof(data); ++i) {
+                data[i] = randomWord();
+            }
+            // from two voxels left of the sprite touching the cube to two beyond it
+            px = (int8_t)(randomWord() % (sprite.sizeX + LAYER_COUNT + 3)) - sprite.sizeX - 1;
+            py = (int8_t)(randomWord() % (sprite.sizeY + LAYER_COUNT + 3)) - sprite.sizeY - 1;
+            pz = (int8_t)(randomWord() % (sprite.sizeZ + LAYER_COUNT + 3)) - sprite.sizeZ - 1;
+
+            blit(&sprite, px, py, pz, op);
+
+            errors = 0;
+            for (z = 0; z < LAYER_COUNT; ++z) {
+                for (y = 0; y < LAYER_COUNT; ++y) {
+                    for (x = 0; x < LAYER_COUNT; ++x) {
+                        sx = x - px;
+                        sy = y - py;
+                        sz = z - pz;
+                        inside = sx >= 0 && sx < sprite.sizeX && sy >= 0 && sy < sprite.sizeY &&
+                                 sz >= 0 && sz < sprite.sizeZ;
+                        bit = inside && (data[(sz*sprite.sizeY + sy)*rowBytes + sx/8] & (1 << (sx%8)));
+                        expected = referenceFrame[z][y][x];
+                        if (op == BLIT_OR && bit) {
+                            expected = 1;
+                        } else if (op == BLIT_AND && inside && !bit) {
+                            expected = 0;
+                        } else if (op == BLIT_XOR && bit) {
+                            expected ^= 1;
+                        } else if (op == BLIT_MASK && bit) {
+                            expected = 0;
+                        }
+                        errors += getVoxel(x, y, z) != expected;
+                    }
+                }
+            }
+            if (errors && !failures++) {
+                printf("  blit %s of %ux%ux%u at (%d,%d,%d): %lu voxels differ from seed %u on\n",
+                       opNames[op], sprite.sizeX, sprite.sizeY, sprite.sizeZ, px, py, pz, errors, seed);
+            }
+        }
+    }
+    printf("  %-10s %5lu frames, %lu differ%s\n", "blit", frames, failures, failures ? "  FAILED" : "");
+    return failures == 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Life
+// ---------------------------------------------------------------------------------------
+
+// One generation the straightforward way: 26 getVoxel() calls per voxel
+static void naiveGeneration()
+{
+    static uint8_t next[LAYER_COUNT][LAYER_COUNT][LAYER_COUNT];
+    uint8_t x, y, z, n;
+    int8_t dx, dy, dz;
+
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                n = 0;
+                for (dz = -1; dz <= 1; ++dz) {
+                    for (dy = -1; dy <= 1; ++dy) {
+                        for (dx = -1; dx <= 1; ++dx) {
+                            if (dx || dy || dz) {
+                                n += getVoxel(x+dx, y+dy, z+dz);
+                            }
+                        }
+                    }
+                }
+                next[z][y][x] = getVoxel(x,y,z) ? n >= LIFE_SURVIVE_MIN && n <= LIFE_SURVIVE_MAX
+                                                : n >= LIFE_BIRTH_MIN && n <= LIFE_BIRTH_MAX;
+            }
+        }
+    }
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                alterVoxel(x, y, z, next[z][y][x]);
+            }
+        }
+    }
+}
+
+// Run both versions from random seeds, they have to give the same generations
+static bool runLife()
+{
+    static uint8_t expected[LAYER_COUNT][LAYER_SIZE];
+    unsigned long generations = 0;
+    unsigned long mismatches = 0;
+    double naive = 0;
+    double sliced = 0;
+    double start;
+    uint16_t seed;
+    uint8_t z;
+    uint8_t g;
+
+    for (seed = 1; seed <= LIFE_SEEDS; ++seed) {
+        seedRandom(seed);
+        for (z = 0; z < LAYER_COUNT; ++z) {
+            randomSparseLayer(z, seed * 8 - 1);
+        }
+        for (g = 0; g < LIFE_GENERATIONS; ++g, ++generations) {
+            memcpy(expected, cube, sizeof(expected));
+            start = now();
+            lifeGeneration(LIFE_SURVIVE_MIN, LIFE_SURVIVE_MAX, LIFE_BIRTH_MIN, LIFE_BIRTH_MAX);
+            sliced += now() - start;
+            memcpy(recorded[0], cube, FRAME_SIZE);
+
+            memcpy(cube, expected, sizeof(expected));
+            start = now();
+            naiveGeneration();
+            naive += now() - start;
+            if (memcmp(recorded[0], cube, FRAME_SIZE)) {
+                ++mismatches;
+            }
+        }
+    }
+    consume();
+    printf("  S%u-%u B%u-%u  bit-sliced %8.1f ns/generation, getVoxel %8.1f ns/generation (%.0fx)\n",
+           LIFE_SURVIVE_MIN, LIFE_SURVIVE_MAX, LIFE_BIRTH_MIN, LIFE_BIRTH_MAX, sliced / generations,
+           naive / generations, naive / sliced);
+    printf("  %lu generations from %u seeds, %lu differ%s\n", generations, LIFE_SEEDS, mismatches,
+           mismatches ? "  FAILED" : "");
+    return mismatches == 0;
+}
+
+int main()
+{
+    bool ok = true;
+    uint8_t i;
+
+    printf("LEDcube %ux%ux%u\n", LAYER_COUNT, LAYER_COUNT, LAYER_COUNT);
+    memset(spriteData, 0xA5, sizeof(spriteData));
+    printf("Primitives:\n");
+    for (i = 0; i < sizeof(primitives) / sizeof(primitives[0]); ++i) {
+        runPrimitive(&primitives[i]);
+    }
+    printf("Effects:\n");
+    for (i = 0; i < EFFECTS_COUNT; ++i) {
+        runEffect(i);
+    }
+    printf("Frame scheduler:\n");
+    runScheduler();
+    printf("Serial link:\n");
+    runSerialLink();
+    printf("Compressed stream (%u frames per effect):\n", RECORD_FRAMES);
+    for (i = 0; i < EFFECTS_COUNT; ++i) {
+        ok &= runCompression(i);
+    }
+    printf("Animation container (%u frames per effect):\n", RECORD_FRAMES);
+    for (i = 0; i < EFFECTS_COUNT; ++i) {
+        ok &= runAnimation(i);
+    }
+    printf("Animation upload (%u byte blocks):\n", UPLOAD_BLOCK_SIZE);
+    for (i = 0; i < EFFECTS_COUNT; ++i) {
+        ok &= runUpload(i);
+    }
+    printf("Flow control (%u frames per effect, %u baud, window %u):\n", RECORD_FRAMES, BAUD_RATE,
+           PROTOCOL_WINDOW);
+    for (i = 0; i < EFFECTS_COUNT; ++i) {
+        ok &= runFlowControl(i, 0);
+        ok &= runFlowControl(i, LINK_ERROR_RATE);
+    }
+    printf("Scheduled presentation (%u frames at %.0f fps, %.0f ms send jitter, queue %u):\n",
+           PLAY_FRAMES, 1 / PLAY_INTERVAL, SEND_JITTER * 1000, FRAME_QUEUE_LENGTH);
+    ok &= runPresentation(0, false);
+    ok &= runPresentation(0, true);
+    ok &= runTimedAhead();
+    printf("Reference checks (%u random frames each):\n", CHECK_FRAMES);
+    ok &= runTransforms();
+    ok &= runBlit();
+    printf("Life (%u generations from each of %u seeds):\n", LIFE_GENERATIONS, LIFE_SEEDS);
+    ok &= runLife();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <string.h>
+#include <util/crc16.h>
+#include "encoder.h"
+#include "protocol.h"
+#include "animation.h"
+
+// COBS: every zero is replaced by the distance to the next zero (or to the end of a
+// block of 254 non-zero bytes), the distance to the first zero is prepended.
+static size_t cobsEncode(const uint8_t *data, size_t length, uint8_t *out)
+{
+    size_t codeIndex = 0;
+    size_t written = 1;
+    uint8_t code = 1;
+    size_t i;
+
+    for (i = 0; i < length; ++i) {
+        if (data[i] == 0x00) {
+            out[codeIndex] = code;
+            codeIndex = written++;
+            code = 1;
+        } else {
+            out[written++] = data[i];
+            if (++code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = written++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return written;
+}
+
+size_t encodePacket(uint8_t type, uint8_t sequence, const uint8_t *payload, size_t length, uint8_t *out)
+{
+    uint8_t packet[MAX_PAYLOAD_SIZE + 3];
+    uint8_t crc = 0;
+    size_t written;
+    size_t i;
+
+    if (length > MAX_PAYLOAD_SIZE) {
+        return 0;
+    }
+
+    packet[0] = type;
+    packet[1] = sequence;
+    memcpy(&packet[2], payload, length);
+    for (i = 0; i < length + 2; ++i) {
+        crc = _crc_ibutton_update(crc, packet[i]);
+    }
+    packet[length + 2] = crc;
+
+    written = cobsEncode(packet, length + 3, out);
+    out[written++] = 0x00;
+    return written;
+}
+
+size_t decodePacket(const uint8_t *in, size_t length, uint8_t *out)
+{
+    size_t written = 0;
+    size_t i = 0;
+    uint8_t crc = 0;
+
+    while (i < length) {
+        uint8_t code = in[i++];
+        uint8_t j;
+
+        if (code == 0x00 || i + code - 1 > length) {
+            return 0;
+        }
+        for (j = 1; j < code; ++j) {
+            out[written++] = in[i++];
+        }
+        // a block shorter than 254 bytes ends with a zero, except the last one
+        if (code != 0xFF && i < length) {
+            out[written++] = 0x00;
+        }
+    }
+    if (written < 3) {
+        return 0;
+    }
+    for (i = 0; i < written; ++i) {
+        crc = _crc_ibutton_update(crc, out[i]);
+    }
+    return crc == 0x00 ? written - 1 : 0;
+}
+
+size_t deltaPayload(const uint8_t *previous, const uint8_t *frame, size_t frameSize, uint8_t *out)
+{
+    size_t bitmapSize = frameSize / 8;
+    size_t written = bitmapSize;
+    size_t i;
+
+    memset(out, 0x00, bitmapSize);
+    for (i = 0; i < frameSize; ++i) {
+        if (frame[i] != previous[i]) {
+            out[i / 8] |= (1 << (i % 8));
+            out[written++] = frame[i];
+        }
+    }
+    return written;
+}
+
+size_t rlePayload(const uint8_t *frame, size_t frameSize, uint8_t *out)
+{
+    size_t written = 0;
+    size_t i = 0;
+
+    while (i < frameSize) {
+        uint8_t count = 1;
+        while (i + count < frameSize && count < 0xFF && frame[i + count] == frame[i]) {
+            ++count;
+        }
+        out[written++] = count;
+        out[written++] = frame[i];
+        i += count;
+    }
+    return written;
+}
+
+// Payload of the smallest of PACKET_FRAME, PACKET_RLE and PACKET_DELTA, written to out
+// (at most frameSize bytes). Returns its length, the chosen type is stored in type.
+static size_t framePayload(const uint8_t *previous, const uint8_t *frame, size_t frameSize,
+                           uint8_t *out, uint8_t *type)
+{
+    uint8_t rle[2 * MAX_PAYLOAD_SIZE];
+    uint8_t delta[MAX_PAYLOAD_SIZE + MAX_PAYLOAD_SIZE / 8];
+    size_t rleLength = rlePayload(frame, frameSize, rle);
+    size_t deltaLength = previous ? deltaPayload(previous, frame, frameSize, delta) : (size_t)-1;
+
+    if (deltaLength <= rleLength && deltaLength <= frameSize) {
+        *type = PACKET_DELTA;
+        memcpy(out, delta, deltaLength);
+        return deltaLength;
+    } else if (rleLength < frameSize) {
+        *type = PACKET_RLE;
+        memcpy(out, rle, rleLength);
+        return rleLength;
+    }
+    *type = PACKET_FRAME;
+    memcpy(out, frame, frameSize);
+    return frameSize;
+}
+
+size_t encodeFrame(uint8_t sequence, const uint8_t *previous, const uint8_t *frame, size_t frameSize,
+                   uint8_t *out, uint8_t *type)
+{
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    size_t length = framePayload(previous, frame, frameSize, payload, type);
+
+    return encodePacket(*type, sequence, payload, length, out);
+}
+
+size_t encodeTimedFrame(uint8_t sequence, uint16_t refresh, const uint8_t *previous, const uint8_t *frame,
+                        size_t frameSize, uint8_t *out, uint8_t *type)
+{
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    size_t length = framePayload(previous, frame, frameSize, &payload[2], type);
+
+    payload[0] = refresh & 0xFF;
+    payload[1] = refresh >> 8;
+    return encodePacket(*type | PACKET_TIMED, sequence, payload, length + 2, out);
+}
+
+size_t encodeRawText(const uint8_t *frame, uint8_t layerCount, uint8_t layerSize, uint8_t *out)
+{
+    size_t written = 0;
+    uint8_t z;
+
+    for (z = 0; z < layerCount; ++z) {
+        memcpy(&out[written], "RAW", 3);
+        written += 3;
+        out[written++] = z;
+        memcpy(&out[written], &frame[z * layerSize], layerSize);
+        written += layerSize;
+        out[written++] = '\r';
+        out[written++] = '\n';
+    }
+    return written;
+}
+
+size_t packBits(const uint8_t *data, size_t length, uint8_t *out)
+{
+    size_t written = 0;
+    size_t literals = 0;        // literal bytes collected before i
+    size_t i = 0;
+
+    while (i < length) {
+        size_t run = 1;
+        while (i + run < length && run < 128 && data[i + run] == data[i]) {
+            ++run;
+        }
+        // runs of two only pay off between two other runs
+        if (run >= 3 || (run == 2 && literals == 0)) {
+            if (literals) {
+                out[written++] = literals - 1;
+                memcpy(&out[written], &data[i - literals], literals);
+                written += literals;
+                literals = 0;
+            }
+            out[written++] = 0x80 | (run - 1);
+            out[written++] = data[i];
+            i += run;
+        } else {
+            ++literals;
+            ++i;
+            if (literals == 128) {
+                out[written++] = literals - 1;
+                memcpy(&out[written], &data[i - literals], literals);
+                written += literals;
+                literals = 0;
+            }
+        }
+    }
+    if (literals) {
+        out[written++] = literals - 1;
+        memcpy(&out[written], &data[i - literals], literals);
+        written += literals;
+    }
+    return written;
+}
+
+size_t animationHeader(uint8_t layerCount, uint16_t frameCount, uint8_t *out)
+{
+    out[0] = ANIMATION_MAGIC;
+    out[1] = layerCount;
+    out[2] = frameCount;
+    out[3] = frameCount >> 8;
+    return ANIMATION_HEADER_SIZE;
+}
+
+size_t animationFrame(const uint8_t *previous, const uint8_t *frame, size_t frameSize,
+                      uint8_t duration, uint8_t *out)
+{
+    uint8_t difference[MAX_PAYLOAD_SIZE];
+    uint8_t delta[MAX_PAYLOAD_SIZE + MAX_PAYLOAD_SIZE / 128 + 1];
+    size_t keyLength;
+    size_t deltaLength;
+    size_t i;
+
+    out[1] = duration;
+    keyLength = packBits(frame, frameSize, &out[2]);
+    if (previous) {
+        for (i = 0; i < frameSize; ++i) {
+            difference[i] = previous[i] ^ frame[i];
+        }
+        deltaLength = packBits(difference, frameSize, delta);
+        if (deltaLength < keyLength) {
+            out[0] = ANIMATION_DELTA;
+            memcpy(&out[2], delta, deltaLength);
+            return deltaLength + 2;
+        }
+    }
+    out[0] = 0x00;
+    return keyLength + 2;
+}
+
+size_t encodeAnimation(const uint8_t *frames, size_t count, uint8_t layerCount, size_t frameSize,
+                       uint8_t *out)
+{
+    const uint8_t *previous = NULL;
+    size_t written = ANIMATION_HEADER_SIZE;
+    uint16_t frameCount = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        const uint8_t *frame = &frames[i * frameSize];
+        uint8_t duration = 1;
+        while (i + duration < count && duration < 0xFF &&
+               !memcmp(&frames[(i + duration) * frameSize], frame, frameSize)) {
+            ++duration;
+        }
+        written += animationFrame(previous, frame, frameSize, duration, &out[written]);
+        previous = frame;
+        ++frameCount;
+        i += duration;
+    }
+    animationHeader(layerCount, frameCount, out);
+    return written;
+}
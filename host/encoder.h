@@ -0,0 +1,75 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Host side encoder for the serial protocols (See ../protocol.h)
+
+#ifndef LEDCUBE_HOST_ENCODER_H
+#define LEDCUBE_HOST_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest payload encodePacket() accepts
+#define MAX_PAYLOAD_SIZE 1024
+
+// Maximum size of an encoded packet with the given payload length
+#define ENCODED_PACKET_SIZE(length) ((length) + 3 + ((length) + 3) / 254 + 2)
+
+// Encode a binary packet: COBS encoded [type][sequence][payload][crc8] followed by 0x00.
+// Returns the number of bytes written to out.
+size_t encodePacket(uint8_t type, uint8_t sequence, const uint8_t *payload, size_t length, uint8_t *out);
+
+// Payload of a PACKET_DELTA: dirty bitmap and the changed bytes. Returns its length.
+size_t deltaPayload(const uint8_t *previous, const uint8_t *frame, size_t frameSize, uint8_t *out);
+
+// Payload of a PACKET_RLE: [count][value] pairs. Returns its length.
+size_t rlePayload(const uint8_t *frame, size_t frameSize, uint8_t *out);
+
+// Encode a frame with the smallest of PACKET_FRAME, PACKET_RLE and PACKET_DELTA.
+// Pass previous = NULL if the cube doesn't have the previous frame (forces a keyframe).
+// Returns the number of bytes written to out, the chosen type is stored in type.
+size_t encodeFrame(uint8_t sequence, const uint8_t *previous, const uint8_t *frame, size_t frameSize,
+                   uint8_t *out, uint8_t *type);
+
+// Like encodeFrame(), but the cube shows the frame at the given refresh (PACKET_TIMED).
+// The chosen type is stored without PACKET_TIMED.
+size_t encodeTimedFrame(uint8_t sequence, uint16_t refresh, const uint8_t *previous, const uint8_t *frame,
+                        size_t frameSize, uint8_t *out, uint8_t *type);
+
+// Decode a reply of the cube (encoded packet without the terminating zero) into
+// [type] [sequence] [payload ...]. Returns its length, 0 if the packet is invalid.
+size_t decodePacket(const uint8_t *in, size_t length, uint8_t *out);
+
+// Encode a frame with the text protocol ("RAW<layer><bytes>\r\n" per layer).
+// Returns the number of bytes written to out.
+size_t encodeRawText(const uint8_t *frame, uint8_t layerCount, uint8_t layerSize, uint8_t *out);
+
+// ---------------------------------------------------------------------------------------
+// Animation container (See ../animation.h)
+// ---------------------------------------------------------------------------------------
+
+// PackBits encoding of data. Returns the number of bytes written to out (at most
+// length + (length + 127) / 128).
+size_t packBits(const uint8_t *data, size_t length, uint8_t *out);
+
+// Container header for frameCount frames. Returns the number of bytes written to out.
+size_t animationHeader(uint8_t layerCount, uint16_t frameCount, uint8_t *out);
+
+// Encode a frame as keyframe or as XOR delta, whatever is smaller. Pass previous = NULL
+// for the first frame (forces a keyframe). Returns the number of bytes written to out.
+size_t animationFrame(const uint8_t *previous, const uint8_t *frame, size_t frameSize,
+                      uint8_t duration, uint8_t *out);
+
+// Encode a sequence of frames shown one scheduler frame each into a container. Equal
+// frames in a row are merged into one with a longer duration.
+// Returns the number of bytes written to out.
+size_t encodeAnimation(const uint8_t *frames, size_t count, uint8_t layerCount, size_t frameSize,
+                       uint8_t *out);
+
+// Bytes per second on a serial line with 8N1 framing
+#define SERIAL_BYTES_PER_SECOND(baud) ((baud) / 10.0)
+
+#endif
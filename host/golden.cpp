@@ -0,0 +1,185 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Golden frame check of the effects.
+// Build with -DARDUINO_X4 or -DARDUINO_X8 (see Makefile).
+//
+//   golden record <out.txt>    run every effect and write its frame stream
+//   golden compare <in.txt>    run every effect and compare it with a recorded stream
+//
+// A virtual clock stands in for the display ISR: every simulated refresh latches the
+// presented frame and feeds the frame scheduler, the main loop advances the effect by
+// the due frames exactly like loop() in LEDcube.ino. No time passes in between, so a
+// minute of effects takes a few milliseconds. Each effect runs for RUN_SECONDS, then it
+// is asked to finish and has to do so within FINISH_SECONDS.
+//
+// The stream has one line per shown frame: the scheduler frame it was presented at and
+// a hash of its content. Frames which didn't change are left out.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "global.h"
+#include "draw.h"
+#include "effects.h"
+#include "scheduler.h"
+#include "random.h"
+
+#define REFRESH_TICKS  1560         // Timer1 ticks per refresh (See LEDcube.ino)
+#define RUN_SECONDS    30
+#define FINISH_SECONDS 30           // blink has to complete a slow down first
+#define RUN_FRAMES     ((uint32_t)RUN_SECONDS * FRAME_RATE)
+#define FINISH_FRAMES  ((uint32_t)FINISH_SECONDS * FRAME_RATE)
+#define LINE_SIZE      64
+
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][LAYER_SIZE];
+extern uint8_t presentedBuffer;
+
+#define EFFECT_NAME(name, interval) #name,
+static const char *effectNames[EFFECTS_COUNT] = {
+    EFFECT_LIST(EFFECT_NAME)
+};
+#undef EFFECT_NAME
+
+static FILE *stream;
+static bool recording;
+static unsigned long lineNumber;
+static bool failed;
+
+// FNV-1a over plane 0 of a frame, the effects only draw on/off frames
+static uint32_t streamHash(const uint8_t *frame)
+{
+    uint32_t hash = 2166136261u;
+    uint16_t i;
+
+    for (i = 0; i < FRAME_SIZE; ++i) {
+        hash = (hash ^ frame[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Write a line of the stream, or compare it with the next recorded one.
+// Returns false on the first difference.
+static bool emit(const char *line)
+{
+    char expected[LINE_SIZE];
+    size_t length;
+
+    ++lineNumber;
+    if (recording) {
+        fprintf(stream, "%s\n", line);
+        return true;
+    }
+    if (!fgets(expected, sizeof(expected), stream)) {
+        expected[0] = 0;
+    }
+    length = strlen(expected);
+    if (length && expected[length-1] == '\n') {
+        expected[length-1] = 0;
+    }
+    if (strcmp(expected, line)) {
+        printf("  line %lu: expected \"%s\", got \"%s\"\n", lineNumber,
+               expected[0] ? expected : "<end>", line);
+        return false;
+    }
+    return true;
+}
+
+// One simulated refresh of the display ISR
+static void refresh()
+{
+    latchFrame();
+    schedulerTick(REFRESH_TICKS);
+}
+
+// Run an effect on the virtual clock and emit its frames.
+// Returns false if its stream differs or it doesn't finish in time.
+static bool runEffect(uint8_t index)
+{
+    char line[LINE_SIZE];
+    uint32_t frame = 0;
+    uint32_t hash;
+    uint32_t previousHash = 0;
+    uint8_t frames;
+    bool shouldFinish = false;
+
+    seedRandom(1);
+    dueFrames = 0;
+    frameTime = 0;
+    startEffect(index);
+
+    snprintf(line, sizeof(line), "effect %u %s", index, effectNames[index]);
+    if (!emit(line)) {
+        return false;
+    }
+    while (!isEffectFinished()) {
+        if (frame >= RUN_FRAMES + FINISH_FRAMES) {
+            printf("  effect %u (%s) didn't finish within %u s\n", index, effectNames[index],
+                   FINISH_SECONDS);
+            return false;
+        }
+        refresh();
+        frames = takeFrames();
+        if (!frames) {
+            continue;
+        }
+        shouldFinish = frame >= RUN_FRAMES;
+        processEffect(shouldFinish, frames);
+        frame += frames;
+
+        hash = streamHash(cubeBuffer[presentedBuffer][0][0]);
+        if (hash != previousHash) {
+            snprintf(line, sizeof(line), "%lu %08lx", (unsigned long)frame, (unsigned long)hash);
+            if (!emit(line)) {
+                return false;
+            }
+            previousHash = hash;
+        }
+    }
+    snprintf(line, sizeof(line), "finished %lu", (unsigned long)frame);
+    if (!emit(line)) {
+        return false;
+    }
+    printf("  effect %-2u %-18s finished %5.2f s after the request\n", index, effectNames[index],
+           (double)(frame - RUN_FRAMES) / FRAME_RATE);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t i;
+
+    if (argc != 3 || (strcmp(argv[1], "record") && strcmp(argv[1], "compare"))) {
+        fprintf(stderr, "usage: %s record <out.txt> | compare <in.txt>\n", argv[0]);
+        return 1;
+    }
+    recording = !strcmp(argv[1], "record");
+    stream = fopen(argv[2], recording ? "w" : "r");
+    if (!stream) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    printf("Golden frames (%ux%ux%u, %u s per effect): %s\n", LAYER_COUNT, LAYER_COUNT, LAYER_COUNT,
+           RUN_SECONDS, argv[2]);
+    for (i = 0; i < EFFECTS_COUNT; ++i) {
+        if (!runEffect(i)) {
+            failed = true;
+            break;
+        }
+    }
+    if (!failed && !recording && fgetc(stream) != EOF) {
+        printf("  line %lu: the recorded stream has more effects\n", lineNumber + 1);
+        failed = true;
+    }
+    fclose(stream);
+    if (failed) {
+        printf("  FAILED%s\n", recording ? "" : " (make golden-record after an intended change)");
+        return 1;
+    }
+    printf("  %s\n", recording ? "recorded" : "all effects match");
+    return 0;
+}
@@ -0,0 +1,269 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Headless renderer: draws frames of the cube in an isometric view, so effects can be
+// looked at (and diffed) without the hardware.
+// Build with -DARDUINO_X4, -DARDUINO_X8 or -DHOST_X16 (see Makefile).
+//
+//   render effect <effect> <frames> <out>   render an effect, one image per scheduler frame
+//   render raw <in.raw> <out>               render raw frames (See anim.cpp), on/off only
+//
+// <out> is a single PPM file holding all the images one after the other (a netpbm
+// stream, e.g. ffmpeg -f image2pipe -c:v ppm -i out.ppm out.gif), or one file per image
+// if it contains a printf pattern for the frame number (e.g. frame%04d.ppm).
+//
+// Voxels are shown with the level the ISR would give them: the BAM level of gray frames,
+// the global brightness for on/off frames. Switched off LEDs are drawn as faint dots.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "global.h"
+#include "draw.h"
+#include "cube.h"
+#include "effects.h"
+#include "random.h"
+
+// Pixels between two neighbouring LEDs
+#if LAYER_COUNT == 4
+#define PITCH 32
+#elif LAYER_COUNT == 8
+#define PITCH 20
+#else
+#define PITCH 12
+#endif
+
+// Isometric projection: x runs to the lower right, y to the lower left, z upwards
+#define STEP_X  (PITCH * 7 / 8)     // horizontal offset per x/y step (about cos 30°)
+#define STEP_Y  (PITCH / 2)         // vertical offset per x/y step
+#define STEP_Z  PITCH
+#define MARGIN  PITCH
+#define RADIUS  (PITCH / 4)         // LED dot
+#define DOT     (2*RADIUS + 1)
+#define WIDTH   (2*(LAYER_COUNT-1)*STEP_X + 2*MARGIN)
+#define HEIGHT  (2*(LAYER_COUNT-1)*STEP_Y + (LAYER_COUNT-1)*STEP_Z + 2*MARGIN)
+
+#define BACKGROUND 0x10
+#define MAX_FRAMES 20000
+
+typedef Cube<LAYER_COUNT> LEDcube;
+
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][LAYER_SIZE];
+extern bool grayBuffer[CUBE_BUFFER_COUNT];
+extern uint8_t presentedBuffer;
+extern volatile uint8_t displayLevel;
+
+static uint8_t image[HEIGHT][WIDTH][3];
+static uint8_t grid[HEIGHT][WIDTH][3];                              // all LEDs switched off
+static uint32_t dotOffset[LAYER_COUNT][LAYER_COUNT][LAYER_COUNT];  // [z][y][x] top left pixel
+static uint8_t dotColor[MAX_LEVEL+1][DOT*DOT][3];                   // dot of every level
+static uint8_t rawFrames[MAX_FRAMES][FRAME_SIZE];
+
+static FILE *output;
+static const char *outputName;
+static unsigned long imageCount;
+static double renderTime;       // ns
+
+static double now()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Draw a dot, overlapping dots keep the brighter pixel (the order doesn't matter)
+static inline void drawDot(uint32_t offset, const uint8_t (*color)[3])
+{
+    uint8_t *row = image[0][0] + offset;
+    uint8_t i, j, c;
+
+    for (i = 0; i < DOT; ++i) {
+        for (j = 0; j < DOT; ++j) {
+            for (c = 0; c < 3; ++c) {
+                if (color[j][c] > row[j*3 + c]) {
+                    row[j*3 + c] = color[j][c];
+                }
+            }
+        }
+        row += WIDTH * 3;
+        color += DOT;
+    }
+}
+
+// Precompute the dot positions, the dot of every level and the image of the switched off
+// cube. The dots are soft discs, the level sets the light output (BAM is linear), the
+// images are gamma encoded.
+static void setup()
+{
+    static const uint8_t lit[3] = { 90, 170, 255 };
+    static const uint8_t dark[3] = { 40, 40, 48 };
+    uint8_t x, y, z, c;
+    int dx, dy;
+    int level;
+    double weight;
+    double light;
+
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                int sx = MARGIN + (LAYER_COUNT-1 + x - y) * STEP_X - RADIUS;
+                int sy = MARGIN + (LAYER_COUNT-1 - z) * STEP_Z + (x + y) * STEP_Y - RADIUS;
+                dotOffset[z][y][x] = ((uint32_t)sy * WIDTH + sx) * 3;
+            }
+        }
+    }
+    for (level = 0; level <= MAX_LEVEL; ++level) {
+        light = pow((double)level / MAX_LEVEL, 1 / 2.2);
+        for (dy = -RADIUS; dy <= RADIUS; ++dy) {
+            for (dx = -RADIUS; dx <= RADIUS; ++dx) {
+                weight = 1.5 - sqrt(dx*dx + dy*dy) / RADIUS;
+                weight = weight < 0 ? 0 : (weight > 1 ? 1 : weight);
+                for (c = 0; c < 3; ++c) {
+                    double value = dark[c] + (lit[c] - dark[c]) * light;
+                    dotColor[level][(dy+RADIUS)*DOT + dx+RADIUS][c] = (uint8_t)(value * weight + 0.5);
+                }
+            }
+        }
+    }
+    memset(image, BACKGROUND, sizeof(image));
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                drawDot(dotOffset[z][y][x], dotColor[0]);
+            }
+        }
+    }
+    memcpy(grid, image, sizeof(grid));
+}
+
+// Render a frame of BAM planes. On/off frames only use plane 0 and show onLevel.
+// Only the lit voxels are drawn on top of the switched off cube.
+static void renderFrame(const uint8_t (*planes)[LAYER_COUNT][LAYER_SIZE], bool gray, uint8_t onLevel)
+{
+    uint8_t x, y, z, plane;
+    uint8_t index, mask, level;
+    double start = now();
+
+    memcpy(image, grid, sizeof(image));
+    for (z = 0; z < LAYER_COUNT; ++z) {
+        for (y = 0; y < LAYER_COUNT; ++y) {
+            for (x = 0; x < LAYER_COUNT; ++x) {
+                index = LEDcube::voxelIndex(x, y);
+                mask = LEDcube::voxelMask(x, y);
+                if (!gray) {
+                    level = (planes[0][z][index] & mask) ? onLevel : 0;
+                } else {
+                    level = 0;
+                    for (plane = 0; plane < BAM_BITS; ++plane) {
+                        level = (level << 1) | ((planes[plane][z][index] & mask) ? 1 : 0);
+                    }
+                }
+                if (level) {
+                    drawDot(dotOffset[z][y][x], dotColor[level]);
+                }
+            }
+        }
+    }
+    renderTime += now() - start;
+}
+
+// Append the image to the stream, or write it to a file of its own
+static void writeImage()
+{
+    char name[256];
+    FILE *file = output;
+
+    if (strchr(outputName, '%')) {
+        snprintf(name, sizeof(name), outputName, (int)imageCount);
+        file = fopen(name, "wb");
+    }
+    if (!file) {
+        perror(outputName);
+        exit(1);
+    }
+    fprintf(file, "P6\n%u %u\n255\n", WIDTH, HEIGHT);
+    if (fwrite(image, sizeof(image), 1, file) != 1) {
+        perror(outputName);
+        exit(1);
+    }
+    if (file != output) {
+        fclose(file);
+    }
+    ++imageCount;
+}
+
+// Render an effect from the presented frames, one image per scheduler frame
+static void renderEffect(uint8_t effect, unsigned long count)
+{
+    unsigned long i;
+
+    seedRandom(1);
+    startEffect(effect);
+    for (i = 0; i < count; ++i) {
+        processEffect(false, 1);
+        if (isEffectFinished()) {
+            startEffect(effect);
+        }
+        renderFrame(cubeBuffer[presentedBuffer], grayBuffer[presentedBuffer], displayLevel);
+        writeImage();
+    }
+    forceFinishEffect();
+}
+
+// Render raw on/off frames of FRAME_SIZE bytes
+static void renderRaw(const char *name)
+{
+    FILE *file = fopen(name, "rb");
+    size_t count;
+    size_t i;
+
+    if (!file) {
+        perror(name);
+        exit(1);
+    }
+    count = fread(rawFrames, FRAME_SIZE, MAX_FRAMES, file);
+    fclose(file);
+    for (i = 0; i < count; ++i) {
+        renderFrame((const uint8_t (*)[LAYER_COUNT][LAYER_SIZE])rawFrames[i], false, MAX_LEVEL);
+        writeImage();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool effect = argc == 5 && !strcmp(argv[1], "effect");
+    bool raw = argc == 4 && !strcmp(argv[1], "raw");
+
+    if ((!effect && !raw) || (effect && atoi(argv[2]) >= EFFECTS_COUNT)) {
+        fprintf(stderr, "usage: %s effect <effect 0..%u> <frames> <out> | raw <in.raw> <out>\n",
+                argv[0], EFFECTS_COUNT - 1);
+        return 1;
+    }
+    outputName = argv[argc-1];
+    if (!strchr(outputName, '%')) {
+        output = fopen(outputName, "wb");
+        if (!output) {
+            perror(outputName);
+            return 1;
+        }
+    }
+
+    setup();
+    if (effect) {
+        renderEffect(atoi(argv[2]), strtoul(argv[3], 0, 10));
+    } else {
+        renderRaw(argv[2]);
+    }
+    if (output) {
+        fclose(output);
+    }
+    fprintf(stderr, "%lu images of %ux%u, %.0f frames/s rendered\n", imageCount, WIDTH, HEIGHT,
+            imageCount ? imageCount * 1e9 / renderTime : 0.0);
+    return 0;
+}
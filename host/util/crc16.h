@@ -0,0 +1,46 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+// Stand-in for avr-libc's <util/crc16.h> (same algorithms, written in C)
+
+#ifndef LEDCUBE_HOST_UTIL_CRC16_H
+#define LEDCUBE_HOST_UTIL_CRC16_H
+
+#include <stdint.h>
+
+// CRC16 (polynomial x^16 + x^15 + x^2 + 1, reflected, as used by Modbus with 0xFFFF)
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t data)
+{
+    uint8_t i;
+
+    crc ^= data;
+    for (i = 0; i < 8; ++i) {
+        if (crc & 0x01) {
+            crc = (crc >> 1) ^ 0xA001;
+        } else {
+            crc >>= 1;
+        }
+    }
+    return crc;
+}
+
+// Dallas/Maxim CRC8 (polynomial x^8 + x^5 + x^4 + 1, reflected)
+static inline uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data)
+{
+    uint8_t i;
+
+    crc = crc ^ data;
+    for (i = 0; i < 8; i++) {
+        if (crc & 0x01) {
+            crc = (crc >> 1) ^ 0x8C;
+        } else {
+            crc >>= 1;
+        }
+    }
+    return crc;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <avr/interrupt.h>
+#include "profiler.h"
+#include "protocol.h"
+#include "scheduler.h"
+#include "uart.h"
+
+#define CYCLES_PER_TICK 8       // Timer1 prescaler
+
+#if PROFILER
+
+ProfileCounter isrProfile = { 0xFFFF, 0, 0, 0 };     // written by the ISR
+uint32_t profileClock;                              // written by the ISR
+ProfileCounter loopProfile = { 0xFFFF, 0, 0, 0 };
+ProfileCounter effectProfile = { 0xFFFF, 0, 0, 0 };
+uint32_t loopStart;
+uint32_t effectStart;
+uint32_t statsStart;            // time of the last report
+uint32_t serialBytes;
+
+// Timer1 ticks since start-up (wraps after 39 minutes)
+uint32_t profileTime()
+{
+    uint32_t time;
+    uint16_t ticks;
+    uint8_t sreg = SREG;
+
+    cli();
+    time = profileClock;
+    ticks = TCNT1;
+    if (TIFR & (1<<OCF1A)) {
+        // the period has finished, but the ISR didn't run yet
+        ticks = TCNT1;
+        time += OCR1A + 1;
+    }
+    SREG = sreg;
+    return time + ticks;
+}
+
+// Add the time since start to a counter (saturated to 16 bit)
+static void profileSince(ProfileCounter *counter, uint32_t start)
+{
+    uint32_t ticks = profileTime() - start;
+
+    profileAdd(counter, ticks > 0xFFFF ? 0xFFFF : ticks);
+}
+
+void profileLoopStart()
+{
+    loopStart = profileTime();
+}
+
+void profileLoopEnd()
+{
+    profileSince(&loopProfile, loopStart);
+}
+
+void profileEffectStart()
+{
+    effectStart = profileTime();
+}
+
+void profileEffectEnd()
+{
+    profileSince(&effectProfile, effectStart);
+}
+
+void profileSerialByte()
+{
+    ++serialBytes;
+}
+
+// Send "<name> <min> <avg> <max>" in CPU cycles and start over
+static void printCounter(const char *name, ProfileCounter *counter)
+{
+    uartPrint(name);
+    if (counter->count) {
+        uartPrint(" ");
+        uartPrintNumber((uint32_t)counter->min * CYCLES_PER_TICK);
+        uartPrint(" ");
+        uartPrintNumber(counter->sum / counter->count * CYCLES_PER_TICK);
+        uartPrint(" ");
+        uartPrintNumber((uint32_t)counter->max * CYCLES_PER_TICK);
+    }
+    uartPrintln("");
+    counter->min = 0xFFFF;
+    counter->max = 0;
+    counter->sum = 0;
+    counter->count = 0;
+}
+
+#endif
+
+// Send "<name> <value>"
+static void printValue(const char *name, uint32_t value)
+{
+    uartPrint(name);
+    uartPrint(" ");
+    uartPrintNumber(value);
+    uartPrintln("");
+}
+
+// Send the statistics since the last call (STATS command)
+void printStats()
+{
+#if PROFILER
+    ProfileCounter isr;
+    uint32_t now = profileTime();
+    uint32_t elapsed = now - statsStart;
+    uint32_t frames = elapsed / TICKS_PER_FRAME;
+    uint8_t oldSREG = SREG;
+
+    // take the ISR counter over in one piece
+    cli();
+    isr = isrProfile;
+    isrProfile.min = 0xFFFF;
+    isrProfile.max = 0;
+    isrProfile.sum = 0;
+    isrProfile.count = 0;
+    SREG = oldSREG;
+
+    statsStart = now;
+    // scale the divisors down instead of the dividends up: no 64 bit division in the
+    // firmware (the ISR sum is less than elapsed, up to 42 million bytes fit)
+    if (frames) {
+        printValue("ISR LOAD %", isr.sum / (elapsed / 100));
+        printValue("SERIAL BYTES/S", serialBytes * FRAME_RATE / frames);
+    }
+    serialBytes = 0;
+    printCounter("ISR CYCLES", &isr);
+    printCounter("LOOP CYCLES", &loopProfile);
+    printCounter("EFFECT CYCLES", &effectProfile);
+#endif
+    printValue("FRAME OVERRUNS", getFrameOverruns());
+    printValue("UART OVERRUNS", getUartOverruns());
+    printValue("UART DROPPED", getUartDroppedBytes());
+    printValue("PROTOCOL ERRORS", getProtocolErrors());
+    printValue("PROTOCOL LOST", getProtocolLostFrames());
+    uartPrintln("STATS");
+}
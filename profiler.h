@@ -0,0 +1,102 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_PROFILER_H
+#define LEDCUBE_PROFILER_H
+
+#include <Arduino.h>
+
+// Set to 1 to measure the time spent in the display ISR, the main loop and the effects.
+// The measurements cost about 40 cycles per ISR call, so release builds leave it off.
+#ifndef PROFILER
+#define PROFILER 0
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Profiler
+// ---------------------------------------------------------------------------------------
+// All times are measured in Timer1 ticks (8 CPU cycles) and reported in CPU cycles.
+// Timer1 runs in CTC mode, so the ISR adds every finished period to a running clock.
+
+struct ProfileCounter {
+    uint16_t min;               // Timer1 ticks
+    uint16_t max;
+    uint32_t sum;
+    uint32_t count;
+};
+
+#if PROFILER
+
+extern ProfileCounter isrProfile;
+extern uint32_t profileClock;
+
+// Add a measurement to a counter
+static inline void profileAdd(ProfileCounter *counter, uint16_t ticks)
+{
+    if (ticks < counter->min) {
+        counter->min = ticks;
+    }
+    if (ticks > counter->max) {
+        counter->max = ticks;
+    }
+    counter->sum += ticks;
+    ++counter->count;
+}
+
+// ISR: account for the finished Timer1 period (before OCR1A is changed)
+static inline void profileIsrStart()
+{
+    profileClock += OCR1A + 1;
+}
+
+// ISR: time since the compare match, including the interrupt latency
+static inline void profileIsrEnd()
+{
+    uint16_t ticks = TCNT1;
+
+    if (TIFR & (1<<OCF1A)) {
+        // the next period started while the ISR was still running
+        ticks = TCNT1 + OCR1A + 1;
+    }
+    profileAdd(&isrProfile, ticks);
+}
+
+// Timer1 ticks since start-up (wraps after 39 minutes)
+uint32_t profileTime();
+
+// Main loop: start and end of a loop iteration (without sleeping) or effect tick
+void profileLoopStart();
+void profileLoopEnd();
+void profileEffectStart();
+void profileEffectEnd();
+// Main loop: a byte has been received
+void profileSerialByte();
+
+#define PROFILE_ISR_START()    profileIsrStart()
+#define PROFILE_ISR_END()      profileIsrEnd()
+#define PROFILE_LOOP_START()   profileLoopStart()
+#define PROFILE_LOOP_END()     profileLoopEnd()
+#define PROFILE_EFFECT_START() profileEffectStart()
+#define PROFILE_EFFECT_END()   profileEffectEnd()
+#define PROFILE_SERIAL_BYTE()  profileSerialByte()
+
+#else
+
+#define PROFILE_ISR_START()
+#define PROFILE_ISR_END()
+#define PROFILE_LOOP_START()
+#define PROFILE_LOOP_END()
+#define PROFILE_EFFECT_START()
+#define PROFILE_EFFECT_END()
+#define PROFILE_SERIAL_BYTE()
+
+#endif
+
+// Send the statistics since the last call (STATS command). The error counters of the
+// serial link and the scheduler are always reported, the times only with PROFILER.
+void printStats();
+
+#endif
@@ -0,0 +1,376 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <util/crc16.h>
+#include "protocol.h"
+#include "global.h"
+#include "draw.h"
+
+#define HEADER_SIZE 2           // type, sequence
+#define DUE_SIZE    2           // refresh of a PACKET_TIMED frame
+// Longest packet accepted: a timed RLE packet with runs of one byte (at least 255 bytes)
+#define MAX_PACKET_LENGTH (FRAME_SIZE > 0x7F ? HEADER_SIZE + DUE_SIZE + 2*FRAME_SIZE + 1 : 0xFF)
+
+extern uint8_t cubeBuffer[CUBE_BUFFER_COUNT][BAM_BITS][LAYER_COUNT][LAYER_SIZE];
+extern uint8_t (*cube)[LAYER_SIZE];
+extern uint8_t presentedBuffer;
+
+struct PacketDecoder {
+    uint8_t remaining;          // bytes left in the current COBS block
+    bool zeroPending;           // a 0x00 follows the current block unless the packet ends
+    bool invalid;               // the content doesn't fit the packet type
+    uint16_t length;            // decoded bytes so far
+    uint8_t held;               // last decoded byte, it is the CRC if the packet ends now
+    uint8_t crc;
+    uint8_t type;               // without PACKET_TIMED
+    bool timed;
+    uint8_t sequence;
+    uint16_t due;               // PACKET_TIMED: refresh the frame is shown at
+    uint8_t *target;            // the back buffer or a slot of the frame queue
+    uint16_t position;          // next byte of the frame
+    uint8_t run;                // PACKET_RLE: count of the current run
+    uint8_t bitmap[DIRTY_BITMAP_SIZE];
+} decoder;
+
+// Frames waiting for their refresh, in the order they have been received
+struct FrameQueue {
+    uint8_t frames[FRAME_QUEUE_LENGTH][FRAME_SIZE];
+    uint16_t due[FRAME_QUEUE_LENGTH];
+    bool timed[FRAME_QUEUE_LENGTH];     // false: shown as soon as possible
+    uint8_t head;               // next frame to present
+    uint8_t count;
+} queue;
+
+uint8_t nextSequence;
+bool sequenceValid;             // nextSequence follows the frame in the back buffer
+bool resending;                 // a NAK has been sent, waiting for frame nextSequence
+bool frameHeld;                 // a received frame waits for the ISR to pick up the presented one
+bool timedPresented;            // the frame presented last has a due refresh (presentAt())
+uint16_t protocolErrors;
+uint16_t protocolLostFrames;
+
+// Forget the packet received so far
+static void resetDecoder()
+{
+    decoder.remaining = 0;
+    decoder.zeroPending = false;
+    decoder.invalid = false;
+    decoder.length = 0;
+    decoder.crc = 0;
+    decoder.position = 0;
+}
+
+// Start over: forget the packet received so far and the previous frame
+void protocolReset()
+{
+    resetDecoder();
+    sequenceValid = false;
+    resending = false;
+    frameHeld = false;
+    queue.count = 0;
+}
+
+// Slot of the frame queue, counted from the next frame to present
+static uint8_t queueSlot(uint8_t index)
+{
+    return (queue.head + index) % FRAME_QUEUE_LENGTH;
+}
+
+// Whether a timed frame has been presented and waits for its refresh
+static bool timedFramePending()
+{
+    return timedPresented && pendingBuffer != NO_BUFFER;
+}
+
+// Choose where the frame of the packet is decoded to: timed frames, and all frames while
+// some are queued or a timed one waits for its refresh, go through the frame queue (a
+// frame held in the back buffer would stop the link until then). A delta starts with its
+// base frame.
+static void startFrame()
+{
+    if (decoder.timed || queue.count || timedFramePending()) {
+        if (queue.count == FRAME_QUEUE_LENGTH) {
+            decoder.invalid = true;     // the host ignored the credits
+            decoder.target = cube[0];
+        } else {
+            decoder.target = queue.frames[queueSlot(queue.count)];
+        }
+    } else {
+        decoder.target = cube[0];
+    }
+
+    if (decoder.type == PACKET_DELTA) {
+        // the changes apply on top of the previous frame
+        if (!sequenceValid || decoder.sequence != nextSequence) {
+            decoder.invalid = true;
+        }
+        if (decoder.target == cube[0]) {
+            revertFrame();
+        } else if (queue.count) {
+            memcpy(decoder.target, queue.frames[queueSlot(queue.count - 1)], FRAME_SIZE);
+        } else {
+            memcpy(decoder.target, cubeBuffer[presentedBuffer][0], FRAME_SIZE);
+        }
+    }
+}
+
+// Finds the next changed byte of a delta frame, starting at position
+static uint16_t nextDirty(uint16_t position)
+{
+    while (position < FRAME_SIZE) {
+        uint8_t bits = decoder.bitmap[position/8] >> (position%8);
+        if (bits == 0x00) {
+            position = (position/8 + 1) * 8;
+        } else {
+            while (!(bits & 0x01)) {
+                bits >>= 1;
+                ++position;
+            }
+            return position;
+        }
+    }
+    return FRAME_SIZE;
+}
+
+// Handle a byte of the packet content (everything but the CRC)
+static void contentByte(uint16_t index, uint8_t data)
+{
+    if (index == 0) {
+        decoder.type = data & ~PACKET_TIMED;
+        decoder.timed = data & PACKET_TIMED;
+        return;
+    } else if (index == 1) {
+        decoder.sequence = data;
+        if (decoder.type == PACKET_FRAME || decoder.type == PACKET_DELTA || decoder.type == PACKET_RLE) {
+            startFrame();
+        }
+        return;
+    }
+
+    index -= HEADER_SIZE;
+    if (decoder.timed) {
+        if (index < DUE_SIZE) {
+            decoder.due = index ? decoder.due | (data << 8) : data;
+            return;
+        }
+        index -= DUE_SIZE;
+    }
+    if (decoder.type == PACKET_FRAME) {
+        if (decoder.position < FRAME_SIZE) {
+            decoder.target[decoder.position++] = data;
+        } else {
+            decoder.invalid = true;
+        }
+    } else if (decoder.type == PACKET_DELTA) {
+        if (index < DIRTY_BITMAP_SIZE) {
+            decoder.bitmap[index] = data;
+            if (index == DIRTY_BITMAP_SIZE-1) {
+                decoder.position = nextDirty(0);
+            }
+        } else if (decoder.position < FRAME_SIZE) {
+            decoder.target[decoder.position] = data;
+            decoder.position = nextDirty(decoder.position+1);
+        } else {
+            decoder.invalid = true;
+        }
+    } else if (decoder.type == PACKET_RLE) {
+        if (!(index & 0x01)) {
+            decoder.run = data;
+        } else if (decoder.run <= FRAME_SIZE - decoder.position) {
+            while (decoder.run--) {
+                decoder.target[decoder.position++] = data;
+            }
+        } else {
+            decoder.invalid = true;
+        }
+    }
+}
+
+// Handle a decoded byte. It is held back by one byte, because only the end of the
+// packet tells whether it is the CRC.
+static void decodedByte(uint8_t data)
+{
+    decoder.crc = _crc_ibutton_update(decoder.crc, data);
+    if (decoder.length != 0 && decoder.length <= MAX_PACKET_LENGTH) {
+        contentByte(decoder.length-1, decoder.held);
+    }
+    decoder.held = data;
+    if (decoder.length <= MAX_PACKET_LENGTH) {
+        ++decoder.length;
+    } else {
+        decoder.invalid = true;
+    }
+}
+
+// Handle a complete packet
+static uint8_t packetReceived()
+{
+    uint16_t contentLength = decoder.length - 1;      // without CRC
+    uint16_t headerLength = HEADER_SIZE + (decoder.timed ? DUE_SIZE : 0);
+
+    // the CRC over all bytes including the transmitted CRC is zero
+    if (decoder.crc != 0x00 || decoder.invalid || contentLength < headerLength) {
+        return PROTOCOL_ERROR;
+    }
+
+    if (decoder.type == PACKET_TEXT && !decoder.timed) {
+        return contentLength == HEADER_SIZE ? PROTOCOL_TEXT : PROTOCOL_ERROR;
+    }
+    if (decoder.type == PACKET_CLOCK && !decoder.timed) {
+        return contentLength == HEADER_SIZE ? PROTOCOL_CLOCK : PROTOCOL_ERROR;
+    }
+
+    // the host repeats frames after a timeout and sends on until it gets the NAK
+    if (sequenceValid && ((uint8_t)(decoder.sequence - nextSequence) >= 0x80 ||
+                          (resending && decoder.sequence != nextSequence))) {
+        return PROTOCOL_DUPLICATE;
+    }
+
+    if (decoder.type == PACKET_FRAME || decoder.type == PACKET_RLE) {
+        if (decoder.position != FRAME_SIZE || (decoder.type == PACKET_RLE && ((contentLength - headerLength) & 0x01))) {
+            return PROTOCOL_ERROR;
+        }
+    } else if (decoder.type == PACKET_DELTA) {
+        if (contentLength < headerLength+DIRTY_BITMAP_SIZE || decoder.position != FRAME_SIZE) {
+            return PROTOCOL_ERROR;
+        }
+    } else {
+        return PROTOCOL_ERROR;
+    }
+
+    if (sequenceValid) {
+        protocolLostFrames += (uint8_t)(decoder.sequence - nextSequence);
+    }
+    nextSequence = decoder.sequence + 1;
+    sequenceValid = true;
+    resending = false;
+    if (decoder.target != cube[0]) {
+        uint8_t slot = queueSlot(queue.count++);
+        queue.due[slot] = decoder.due;
+        queue.timed[slot] = decoder.timed;
+    } else if (pendingBuffer == NO_BUFFER) {
+        present(false);
+        timedPresented = false;
+    } else {
+        frameHeld = true;       // presenting it now would drop the previous frame
+    }
+    return PROTOCOL_FRAME;
+}
+
+// Process a received byte (COBS decoding)
+uint8_t protocolReceive(uint8_t data)
+{
+    uint8_t result = PROTOCOL_BUSY;
+
+    if (data == 0x00) {
+        // end of packet, the zero after the last block is not part of the data
+        if (decoder.length != 0 && decoder.remaining == 0) {
+            result = packetReceived();
+        } else if (decoder.length != 0 || decoder.remaining != 0) {
+            result = PROTOCOL_ERROR;
+        }
+        if (result == PROTOCOL_ERROR) {
+            ++protocolErrors;
+            resending = true;
+        }
+        resetDecoder();
+    } else if (decoder.remaining == 0) {
+        // code byte: number of data bytes up to the next zero + 1
+        if (decoder.zeroPending) {
+            decodedByte(0x00);
+        }
+        decoder.remaining = data - 1;
+        decoder.zeroPending = (data != 0xFF);
+    } else {
+        decodedByte(data);
+        --decoder.remaining;
+    }
+    return result;
+}
+
+// Present a frame waiting for the display or the next queued one
+uint8_t protocolPoll()
+{
+    if (frameHeld) {
+        if (pendingBuffer != NO_BUFFER) {
+            return PROTOCOL_WAIT;
+        }
+        frameHeld = false;
+        present(false);
+        timedPresented = false;
+        return PROTOCOL_CREDIT;
+    }
+    // the back buffer is free: frames are decoded into the queue while it isn't empty
+    if (queue.count && pendingBuffer == NO_BUFFER) {
+        memcpy(cube[0], queue.frames[queue.head], FRAME_SIZE);
+        if (queue.timed[queue.head]) {
+            presentAt(queue.due[queue.head]);
+        } else {
+            present(false);
+        }
+        timedPresented = queue.timed[queue.head];
+        queue.head = queueSlot(1);
+        --queue.count;
+        return PROTOCOL_CREDIT;
+    }
+    return PROTOCOL_IDLE;
+}
+
+// Build a reply packet
+uint8_t protocolReply(uint8_t type, uint8_t *out)
+{
+    uint8_t packet[5];
+    uint8_t size = 0;
+    uint8_t crc = 0;
+    uint8_t codeIndex = 0;
+    uint8_t length = 1;
+    uint8_t i;
+
+    packet[size++] = type;
+    if (type == PACKET_CLOCK) {
+        uint8_t oldSREG = SREG;
+        uint16_t clock;
+
+        cli();
+        clock = refreshClock;
+        SREG = oldSREG;
+        packet[size++] = decoder.sequence;
+        packet[size++] = clock & 0xFF;
+        packet[size++] = clock >> 8;
+    } else {
+        packet[size++] = type == PACKET_ACK ? nextSequence - 1 : nextSequence;
+        packet[size++] = queue.count ? FRAME_QUEUE_LENGTH - queue.count : PROTOCOL_WINDOW - frameHeld;
+    }
+    for (i = 0; i < size; ++i) {
+        crc = _crc_ibutton_update(crc, packet[i]);
+    }
+    packet[size++] = crc;
+
+    // COBS encoding (See protocolReceive())
+    for (i = 0; i < size; ++i) {
+        if (packet[i] == 0x00) {
+            out[codeIndex] = length - codeIndex;
+            codeIndex = length++;
+        } else {
+            out[length++] = packet[i];
+        }
+    }
+    out[codeIndex] = length - codeIndex;
+    out[length++] = 0x00;
+    return length;
+}
+
+// Number of packets dropped because of a wrong CRC, length, type or missing base frame
+uint16_t getProtocolErrors()
+{
+    return protocolErrors;
+}
+
+// Number of frames missing according to the sequence numbers
+uint16_t getProtocolLostFrames()
+{
+    return protocolLostFrames;
+}
@@ -0,0 +1,110 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_PROTOCOL_H
+#define LEDCUBE_PROTOCOL_H
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------------------
+// Binary serial protocol
+// ---------------------------------------------------------------------------------------
+// Entered with the text command "BINARY" while in STATE SERIAL.
+// Every packet is COBS encoded and terminated by 0x00, so payload bytes can't break
+// the framing. Decoded packet:
+//
+//   [type] [sequence] [payload ...] [crc8]
+//
+// The CRC8 (Dallas/Maxim, as _crc_ibutton_update) covers type, sequence and payload.
+// Frame bytes are numbered in cube[z][row] order.
+
+// Packet types
+#define PACKET_FRAME 'F'        // payload: FRAME_SIZE bytes
+#define PACKET_DELTA 'D'        // payload: bitmap of changed bytes (FRAME_SIZE bits, LSB first),
+                                //          followed by the new value of every changed byte.
+                                //          Only applied on top of the frame with sequence-1.
+#define PACKET_RLE   'K'        // payload: pairs of [count][value] filling the whole frame
+#define PACKET_TEXT  'T'        // no payload, return to the text protocol
+#define PACKET_CLOCK 'C'        // no payload, the cube replies with PACKET_CLOCK (See below)
+
+// Flag on PACKET_FRAME, PACKET_DELTA and PACKET_RLE: the payload starts with the refresh
+// [LSB] [MSB] (cube clock) the frame is shown at. The frame waits in the frame queue
+// until then, the ISR switches to it exactly at the start of that refresh.
+#define PACKET_TIMED 0x80
+
+#define DIRTY_BITMAP_SIZE (FRAME_SIZE/8)
+
+// Frames waiting for their refresh, FRAME_SIZE bytes plus due and timed (3 bytes) each:
+// ATmega8 8 x 11 = 88 bytes, ATmega32 4 x 67 = 268 bytes of RAM
+#ifndef FRAME_QUEUE_LENGTH
+#ifdef ARDUINO_X4
+#define FRAME_QUEUE_LENGTH 8
+#else
+#define FRAME_QUEUE_LENGTH 4
+#endif
+#endif
+
+// Every frame packet is answered by the cube with a reply packet (same framing):
+#define PACKET_ACK   'A'        // sequence: last accepted frame, payload: [credits]
+#define PACKET_NAK   'N'        // sequence: frame expected next, payload: [credits]
+// PACKET_CLOCK: sequence of the request, payload: [refreshClock LSB] [MSB] (See draw.h)
+// when the request has been received. A refresh takes 1560 Timer1 ticks (846.4 us) on both
+// cubes, the host maps its timeline onto the refreshes with it.
+//
+// Flow control: the host may send the frames up to sequence + credits of the last reply.
+// A frame received while the ISR didn't pick up the previous untimed one yet waits in the
+// back buffer instead of replacing it, the bytes of the next frame wait in the UART buffer
+// meanwhile. That takes at most one refresh: the ISR picks an untimed frame up at the
+// start of the next one. Once the waiting frame has been presented, the cube sends the
+// new credits (an ACK of the same frame again).
+// While frames are queued or a timed frame waits for its refresh (up to 27 s ahead),
+// every frame goes through the frame queue and the credits are the free queue slots, the
+// link never waits for a timed frame. The cube sends the new credits whenever a slot gets
+// free.
+// A NAK is sent for a packet with a wrong CRC or length, or a delta without its base
+// frame. The cube drops all frames but the expected one until it arrives: the host sends
+// the frames again from there, starting with a keyframe (PACKET_FRAME or PACKET_RLE).
+// Frames the cube already has are ACKed again, so a host may also resend after a timeout.
+#define PROTOCOL_WINDOW 2       // frames the cube takes beyond the last accepted one
+
+// Longest reply packet (COBS encoded, with the terminating zero)
+#define REPLY_PACKET_SIZE 7
+
+// Results of protocolReceive()
+#define PROTOCOL_BUSY  0        // packet not complete yet
+#define PROTOCOL_FRAME 1        // a frame has been received and presented
+#define PROTOCOL_TEXT  2        // the host wants to return to the text protocol
+#define PROTOCOL_ERROR 3        // invalid packet (CRC, length, type or missing base frame), dropped
+#define PROTOCOL_DUPLICATE 4    // frame already received or not the one expected after a NAK, dropped
+#define PROTOCOL_CLOCK 7        // the host asks for the cube clock
+
+// Results of protocolPoll()
+#define PROTOCOL_IDLE   0       // nothing to do
+#define PROTOCOL_WAIT   5       // a frame waits for the display, don't pass any bytes
+#define PROTOCOL_CREDIT 6       // a waiting frame has been presented, send the new credits
+
+// Start over: forget the packet received so far and the previous frame
+void protocolReset();
+
+// Process a received byte. Frame content is decoded straight into the back buffer.
+// Answer PROTOCOL_FRAME and PROTOCOL_DUPLICATE with PACKET_ACK, PROTOCOL_ERROR with PACKET_NAK
+// and PROTOCOL_CLOCK with PACKET_CLOCK.
+uint8_t protocolReceive(uint8_t data);
+
+// Present a frame waiting for the display or the next queued one. Call it before
+// passing the received bytes,
+// PROTOCOL_CREDIT is answered with PACKET_ACK.
+uint8_t protocolPoll();
+
+// Build a reply packet (PACKET_ACK, PACKET_NAK or PACKET_CLOCK), returns its length
+uint8_t protocolReply(uint8_t type, uint8_t *out);
+
+// Number of packets dropped because of a wrong CRC, length, type or missing base frame
+uint16_t getProtocolErrors();
+// Number of frames missing according to the sequence numbers
+uint16_t getProtocolLostFrames();
+
+#endif
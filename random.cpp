@@ -0,0 +1,69 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include "random.h"
+
+static uint16_t randomState = 1;
+static uint16_t coordinateBits;         // unused bits of the last draw for randomCoordinate()
+static uint8_t coordinateBitCount;
+
+void seedRandom(uint16_t seed)
+{
+    randomState = seed ? seed : 1;
+    coordinateBitCount = 0;
+}
+
+uint16_t randomWord()
+{
+    uint16_t x = randomState;
+
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    randomState = x;
+    return x;
+}
+
+uint8_t randomCoordinate()
+{
+    uint8_t coordinate;
+
+    if (coordinateBitCount < COORDINATE_BITS) {
+        coordinateBits = randomWord();
+        coordinateBitCount = 16;
+    }
+    coordinate = coordinateBits & (LAYER_COUNT - 1);
+    coordinateBits >>= COORDINATE_BITS;
+    coordinateBitCount -= COORDINATE_BITS;
+    return coordinate;
+}
+
+// The density is worked off from its lowest set bit upwards: a set bit ORs a random
+// word into the mask (p = (1+p)/2), a cleared bit ANDs one (p = p/2). After bit 7 every
+// bit of the mask is set with a probability of density/256. Trailing zero bits are
+// skipped, halving the empty mask doesn't change it.
+uint16_t randomMask(uint8_t density)
+{
+    uint16_t mask = 0;
+    uint8_t bits = 8;
+
+    if (density == 0) {
+        return 0;
+    }
+    while (!(density & 1)) {
+        density >>= 1;
+        --bits;
+    }
+    while (bits--) {
+        if (density & 1) {
+            mask |= randomWord();
+        } else {
+            mask &= randomWord();
+        }
+        density >>= 1;
+    }
+    return mask;
+}
@@ -0,0 +1,39 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_RANDOM_H
+#define LEDCUBE_RANDOM_H
+
+#include <Arduino.h>
+#include "global.h"
+
+// ---------------------------------------------------------------------------------------
+// Pseudo random numbers for the effects
+// ---------------------------------------------------------------------------------------
+// 16 bit xorshift generator (shifts 7, 9, 8), period 2^16-1. Much cheaper than rand() on
+// the AVR: no multiplication, two of the shifts are byte moves. The sequence only
+// depends on the seed, so effects are reproducible after seedRandom().
+
+// Bits per coordinate, LAYER_COUNT is a power of two
+#if LAYER_COUNT == 4
+#define COORDINATE_BITS 2
+#elif LAYER_COUNT == 8
+#define COORDINATE_BITS 3
+#else
+#define COORDINATE_BITS 4
+#endif
+
+// Restart the sequence (0 is replaced by 1, the generator would get stuck on it)
+void seedRandom(uint16_t seed);
+// Next 16 random bits
+uint16_t randomWord();
+// Random coordinate 0..LAYER_COUNT-1. Several coordinates are cut from one
+// randomWord(), the remaining bits are kept for the next call.
+uint8_t randomCoordinate();
+// 16 random bits, each of them set with a probability of density/256
+uint16_t randomMask(uint8_t density);
+
+#endif
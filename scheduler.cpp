@@ -0,0 +1,63 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "scheduler.h"
+
+volatile uint8_t dueFrames;     // written by the ISR and the main loop
+uint16_t frameTime;             // ISR only: Timer1 ticks since the last frame
+uint16_t frameOverruns;         // main loop only
+
+// Number of frames the effects have to advance now (0: no frame is due)
+uint8_t takeFrames()
+{
+    uint8_t frames;
+    uint8_t sreg = SREG;
+
+    cli();
+    frames = dueFrames;
+#if SCHEDULE_POLICY == SCHEDULE_SKIP
+    // all due frames are covered by a single step
+    dueFrames = 0;
+    if (frames > 1) {
+        frameOverruns += frames - 1;
+    }
+#else
+    // one frame per call, the others follow as soon as possible
+    if (frames > MAX_CATCH_UP) {
+        frameOverruns += frames - MAX_CATCH_UP;
+        frames = MAX_CATCH_UP;
+    }
+    if (frames > 1) {
+        ++frameOverruns;
+    }
+    dueFrames = frames ? frames - 1 : 0;
+    frames = frames ? 1 : 0;
+#endif
+    SREG = sreg;
+    return frames;
+}
+
+// Sleep until the next interrupt unless a frame is due
+void waitForInterrupt()
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if (!dueFrames) {
+        sleep_enable();
+        sei();              // the instruction after sei is executed before any interrupt
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
+}
+
+// Number of frames which were not rendered in time
+uint16_t getFrameOverruns()
+{
+    return frameOverruns;
+}
@@ -0,0 +1,61 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_SCHEDULER_H
+#define LEDCUBE_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Effect frames per second
+#ifndef FRAME_RATE
+#define FRAME_RATE 100
+#endif
+
+// What happens with frames which are due while the main loop is still busy
+#define SCHEDULE_CATCH_UP 0     // run them one after the other (at most MAX_CATCH_UP)
+#define SCHEDULE_SKIP     1     // advance the effect by all of them in a single step
+#ifndef SCHEDULE_POLICY
+#define SCHEDULE_POLICY SCHEDULE_CATCH_UP
+#endif
+#define MAX_CATCH_UP 4
+
+// Timer1 ticks (prescaler 8) per frame
+#define TICKS_PER_FRAME (F_CPU / 8 / FRAME_RATE)
+
+// Number of frames covering a time in ms (rounded up)
+#define MS_TO_FRAMES(ms) (((uint32_t)(ms) * FRAME_RATE + 999) / 1000)
+
+// ---------------------------------------------------------------------------------------
+// Frame scheduler
+// ---------------------------------------------------------------------------------------
+// The display ISR hands the time of every refresh to schedulerTick(), which counts
+// the frames falling due. The frame rate therefore follows the crystal without
+// drift. The main loop takes the due frames and sleeps while there is nothing to do.
+
+extern volatile uint8_t dueFrames;
+extern uint16_t frameTime;
+
+// Called by the ISR at the start of a refresh with the refresh time in Timer1 ticks
+// (inline, a function call would make the ISR save all registers)
+static inline void schedulerTick(uint16_t ticks)
+{
+    frameTime += ticks;
+    if (frameTime >= TICKS_PER_FRAME) {
+        frameTime -= TICKS_PER_FRAME;
+        if (dueFrames != 0xFF) {
+            ++dueFrames;
+        }
+    }
+}
+
+// Number of frames the effects have to advance now (0: no frame is due)
+uint8_t takeFrames();
+// Sleep until the next interrupt unless a frame is due
+void waitForInterrupt();
+// Number of frames which were not rendered in time
+uint16_t getFrameOverruns();
+
+#endif
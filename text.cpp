@@ -0,0 +1,105 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include "text.h"
+#include "draw.h"
+#include "cube.h"
+
+#if TEXT_SUPPORTED
+
+typedef Cube<LAYER_COUNT> LEDcube;
+
+#define TEXT_COLUMNS (FONT_WIDTH + 1)           // columns per character, one of them empty
+#define FLY_STEPS (LAYER_COUNT + 2)             // steps per letter, it rests in front for two
+
+extern uint8_t (*cube)[LAYER_SIZE];
+
+char text[TEXT_LENGTH+1] = "LEDcube";
+uint8_t textLength = 7;
+
+// Replace the text by an empty one
+void textClear()
+{
+    textLength = 0;
+}
+
+// Add a character to the text (ignored if the text is full)
+void textAppend(char c)
+{
+    if (textLength < TEXT_LENGTH) {
+        text[textLength++] = c;
+    }
+}
+
+// Column of the text, bit z is the voxel in layer z (the top row of the font is on top)
+static LEDcube::Row textColumn(int16_t column)
+{
+    uint8_t index = column / TEXT_COLUMNS;
+    uint8_t glyphColumn = column % TEXT_COLUMNS;
+
+    if (column < 0 || index >= textLength || glyphColumn == FONT_WIDTH) {
+        return 0;
+    }
+    return (LEDcube::Row)bitswap(fontColumn(text[index], glyphColumn)) << (LAYER_COUNT - 8);
+}
+
+// Draws count text columns from column first on at x, x+1, ... of the face at y. The
+// columns are collected in a layer sized matrix and turned into rows along X with a
+// bit-matrix transpose, so every layer gets a single row write.
+static void drawColumns(int16_t first, uint8_t x, uint8_t count, uint8_t y)
+{
+    LEDcube::Layer matrix = {};
+    uint8_t i;
+
+    for (i = 0; i < count; ++i) {
+        LEDcube::setRow(&matrix, x + i, 0, textColumn(first + i));
+    }
+    LEDcube::transposeLayer(matrix);
+    for (i = 0; i < LAYER_COUNT; ++i) {
+        LEDcube::orRow(cube, y, i, LEDcube::getRow(&matrix, i, 0));
+    }
+}
+
+// Draw a step of a text animation (See text.h)
+bool drawText(uint8_t mode, uint16_t step)
+{
+    int16_t columns = textLength * TEXT_COLUMNS;
+    uint8_t side;
+
+    if (mode == TEXT_SCROLL) {
+        // the text comes in on the right, step 0 is the empty face
+        if ((int16_t)step >= columns + LAYER_COUNT) {
+            return false;
+        }
+        drawColumns(step - LAYER_COUNT, 0, LAYER_COUNT, 0);
+    } else if (mode == TEXT_AROUND) {
+        // 4 sides of LAYER_COUNT-1 columns (the corners belong to the following side).
+        // Every side is drawn onto the front and turned into place: after three turns
+        // by 90 degrees the first one drawn is the left side.
+        if ((int16_t)step >= columns + 4*(LAYER_COUNT-1)) {
+            return false;
+        }
+        for (side = 4; side-- > 0; ) {
+            drawColumns(step - (4-side)*(LAYER_COUNT-1), 0, LAYER_COUNT-1, 0);
+            if (side != 0) {
+                LEDcube::rotate90(cube, AXIS_Z, 1);
+            }
+        }
+    } else if (mode == TEXT_FLY) {
+        // the letter is centered on X and moves from y=LAYER_COUNT-1 to y=0
+        uint8_t index = step / FLY_STEPS;
+        uint8_t y = step % FLY_STEPS;
+
+        if (index >= textLength) {
+            return false;
+        }
+        y = y < LAYER_COUNT ? LAYER_COUNT-1 - y : 0;
+        drawColumns(index * TEXT_COLUMNS, (LAYER_COUNT - FONT_WIDTH) / 2, FONT_WIDTH, y);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_TEXT_H
+#define LEDCUBE_TEXT_H
+
+#include <Arduino.h>
+#include "global.h"
+#include "font.h"
+
+// Text needs a cube which is at least as high as the font
+#define TEXT_SUPPORTED (LAYER_COUNT >= FONT_HEIGHT)
+
+// Longest text (characters)
+#define TEXT_LENGTH 32
+
+// How the text is shown
+#define TEXT_SCROLL 0           // scrolls from right to left across the front face (y=0)
+#define TEXT_AROUND 1           // scrolls around the four side faces
+#define TEXT_FLY    2           // one letter after the other flies from the back to the front
+#define TEXT_MODES  3
+
+// Replace the text by an empty one, textAppend() adds the characters
+void textClear();
+void textAppend(char c);
+
+// Draw step 0, 1, 2, ... of a text animation into the cleared back buffer
+// Returns false once the step is past the end of the animation (nothing drawn).
+bool drawText(uint8_t mode, uint16_t step);
+
+#endif
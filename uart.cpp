@@ -0,0 +1,126 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <avr/interrupt.h>
+#include "uart.h"
+
+#define RX_BUFFER_MASK (UART_RX_BUFFER_SIZE - 1)
+
+uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
+volatile uint8_t rxHead;        // written by the ISR
+volatile uint8_t rxTail;        // written by the main loop
+volatile uint16_t uartOverruns;
+volatile uint16_t uartDroppedBytes;
+
+// Configure the USART (8N1) and enable the receive interrupt
+void uartBegin(uint32_t baud)
+{
+    // double speed mode gives a smaller error at high baud rates
+    uint16_t ubrr = (F_CPU / 8 + baud / 2) / baud - 1;
+
+    UBRRH = ubrr >> 8;
+    UBRRL = ubrr;
+    UCSRA = (1<<U2X);
+    UCSRC = (1<<URSEL) | (1<<UCSZ1) | (1<<UCSZ0);    // URSEL selects UCSRC (shared with UBRRH)
+    UCSRB = (1<<RXEN) | (1<<TXEN) | (1<<RXCIE);
+}
+
+// Number of received bytes waiting in the buffer
+uint8_t uartAvailable()
+{
+    return (rxHead - rxTail) & RX_BUFFER_MASK;
+}
+
+// Take the next received byte out of the buffer
+uint8_t uartRead()
+{
+    uint8_t tail = rxTail;
+    uint8_t data = rxBuffer[tail];
+    rxTail = (tail + 1) & RX_BUFFER_MASK;
+    return data;
+}
+
+// Send a byte
+void uartWrite(uint8_t data)
+{
+    while (!(UCSRA & (1<<UDRE)));
+    UDR = data;
+}
+
+// Send a string
+void uartPrint(const char *text)
+{
+    while (*text) {
+        uartWrite(*text++);
+    }
+}
+
+// Send a string followed by "\r\n"
+void uartPrintln(const char *text)
+{
+    uartPrint(text);
+    uartWrite('\r');
+    uartWrite('\n');
+}
+
+// Send a number in decimal notation
+void uartPrintNumber(uint32_t value)
+{
+    char digits[11];
+    uint8_t i = sizeof(digits) - 1;
+
+    digits[i] = '\0';
+    do {
+        digits[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    uartPrint(&digits[i]);
+}
+
+// Number of bytes lost because the USART received a byte before the last one was read
+uint16_t getUartOverruns()
+{
+    uint8_t oldSREG = SREG;
+    uint16_t value;
+
+    cli();
+    value = uartOverruns;
+    SREG = oldSREG;
+    return value;
+}
+
+// Number of bytes lost because the ring buffer was full
+uint16_t getUartDroppedBytes()
+{
+    uint8_t oldSREG = SREG;
+    uint16_t value;
+
+    cli();
+    value = uartDroppedBytes;
+    SREG = oldSREG;
+    return value;
+}
+
+// Interrupt routine on USART receive complete
+// Stores the received byte in the ring buffer
+ISR(USART_RXC_vect) {
+    // the status needs to be read before UDR
+    uint8_t status = UCSRA;
+    uint8_t data = UDR;
+    uint8_t head = rxHead;
+    uint8_t next = (head + 1) & RX_BUFFER_MASK;
+
+    if (status & (1<<DOR)) {
+        ++uartOverruns;
+    }
+
+    if (next == rxTail) {
+        ++uartDroppedBytes;
+    } else {
+        rxBuffer[head] = data;
+        rxHead = next;
+    }
+};
@@ -0,0 +1,51 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_UART_H
+#define LEDCUBE_UART_H
+
+#include <Arduino.h>
+
+// Size of the receive ring buffer, needs to be a power of two
+#ifndef UART_RX_BUFFER_SIZE
+#ifdef ARDUINO_X4
+#define UART_RX_BUFFER_SIZE 32
+#else
+#define UART_RX_BUFFER_SIZE 128
+#endif
+#endif
+
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) || UART_RX_BUFFER_SIZE > 256
+#error "UART_RX_BUFFER_SIZE needs to be a power of two (max. 256)"
+#endif
+
+// ---------------------------------------------------------------------------------------
+// USART driver
+// ---------------------------------------------------------------------------------------
+// Received bytes are stored by the RX complete interrupt, so they are not lost while
+// the main loop is busy. Sending waits for the transmitter (responses are short).
+
+// Configure the USART (8N1) and enable the receive interrupt
+void uartBegin(uint32_t baud);
+
+// Number of received bytes waiting in the buffer
+uint8_t uartAvailable();
+// Take the next received byte out of the buffer (check uartAvailable() first)
+uint8_t uartRead();
+
+// Send a byte, a string or a string followed by "\r\n"
+void uartWrite(uint8_t data);
+void uartPrint(const char *text);
+void uartPrintln(const char *text);
+// Send a number in decimal notation
+void uartPrintNumber(uint32_t value);
+
+// Number of bytes lost because the USART received a byte before the last one was read
+uint16_t getUartOverruns();
+// Number of bytes lost because the ring buffer was full
+uint16_t getUartDroppedBytes();
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "upload.h"
+
+// Upload states
+#define STATE_NONE       0      // no upload
+#define STATE_RECEIVING  1      // waiting for the next block
+#define STATE_WRITING    2      // a block is being written
+#define STATE_COMMITTING 3      // the first byte is being written
+#define STATE_STARTING   4      // the record of a new upload is being written
+#define STATE_RECORDING  5      // the block count is being written into the record
+
+// Resume state, kept in the EEPROM at UPLOAD_RECORD_ADDRESS in this byte order: the first
+// byte is saved before the block count which covers it, the block count is reset before
+// size and CRC are changed.
+struct UploadRecord {
+    uint8_t firstByte;          // written last
+    uint8_t blocks;             // blocks in the EEPROM
+    uint16_t size;
+    uint16_t crc;
+};
+
+struct Upload {
+    uint8_t state;
+    UploadRecord record;
+} upload;
+
+uint8_t uploadBuffer[BLOCK_ARGUMENTS_SIZE];
+
+// Bytes the EEPROM ready interrupt still has to write
+const uint8_t *volatile writeData;
+volatile uint16_t writeAddress;
+volatile uint8_t writeRemaining;
+
+// Write bytes into the EEPROM in the background. data has to stay unchanged until
+// eepromWriting() returns false.
+static void eepromWrite(uint16_t address, const uint8_t *data, uint8_t length)
+{
+    writeData = data;
+    writeAddress = address;
+    writeRemaining = length;
+    EECR |= (1<<EERIE);         // fires as soon as the EEPROM is ready
+}
+
+// Whether eepromWrite() is still busy
+static bool eepromWriting()
+{
+    return writeRemaining != 0 || (EECR & (1<<EEWE));
+}
+
+// EEPROM ready: start the next write (takes 8.5 ms), stop when all bytes are written
+ISR(EE_RDY_vect) {
+    if (writeRemaining) {
+        EEAR = writeAddress++;
+        EEDR = *writeData++;
+        --writeRemaining;
+        EECR |= (1<<EEMWE);     // EEWE has to follow within 4 cycles
+        EECR |= (1<<EEWE);
+    } else {
+        EECR &= ~(1<<EERIE);
+    }
+}
+
+static uint16_t readWord(uint8_t index)
+{
+    return uploadBuffer[index] | (uploadBuffer[index+1] << 8);
+}
+
+// Load the record of an upload interrupted by a reset
+void uploadInit()
+{
+    eeprom_read_block(&upload.record, (const void *)UPLOAD_RECORD_ADDRESS, sizeof(upload.record));
+    upload.state = STATE_NONE;
+    if (upload.record.size <= UPLOAD_SPACE &&
+        (uint16_t)upload.record.blocks * UPLOAD_BLOCK_SIZE < upload.record.size) {
+        upload.state = STATE_RECEIVING;
+    }
+}
+
+// Start or resume an upload
+uint16_t uploadStart()
+{
+    uint16_t size = readWord(0);
+    uint16_t crc = readWord(2);
+
+    if (size == 0 || size > UPLOAD_SPACE) {
+        return UPLOAD_INVALID;
+    }
+    if (upload.state != STATE_NONE && size == upload.record.size && crc == upload.record.crc) {
+        return upload.record.blocks;
+    }
+    if (eepromWriting()) {
+        return UPLOAD_BUSY;
+    }
+    upload.state = STATE_STARTING;
+    upload.record.blocks = 0;
+    upload.record.size = size;
+    upload.record.crc = crc;
+    eepromWrite(UPLOAD_RECORD_ADDRESS + 1, &upload.record.blocks, sizeof(upload.record) - 1);
+    return 0;
+}
+
+// Handle a block
+uint8_t uploadBlock()
+{
+    uint16_t index = readWord(0);
+    uint16_t address = index * UPLOAD_BLOCK_SIZE;
+    uint8_t crc = 0;
+    uint8_t length = UPLOAD_BLOCK_SIZE;
+    uint8_t i;
+
+    for (i = 0; i < BLOCK_ARGUMENTS_SIZE; ++i) {
+        crc = _crc_ibutton_update(crc, uploadBuffer[i]);
+    }
+    if (crc != 0x00 || upload.state == STATE_NONE) {
+        return BLOCK_NAK;
+    }
+    if (index < upload.record.blocks) {
+        return BLOCK_ACK;       // the ACK got lost
+    }
+    if (index != upload.record.blocks || upload.state != STATE_RECEIVING) {
+        return BLOCK_NAK;
+    }
+
+    if (upload.record.size - address < UPLOAD_BLOCK_SIZE) {
+        length = upload.record.size - address;
+    }
+    if (index == 0) {
+        // invalidates the animation in the EEPROM until the upload is complete
+        upload.record.firstByte = uploadBuffer[2];
+        uploadBuffer[2] = 0xFF;
+    }
+    upload.state = STATE_WRITING;
+    eepromWrite(address, &uploadBuffer[2], length);
+    return BLOCK_WRITING;
+}
+
+// Whether uploadBuffer is in use
+bool uploadBusy()
+{
+    return upload.state != STATE_NONE && upload.state != STATE_RECEIVING;
+}
+
+// Number of blocks in the EEPROM
+uint16_t uploadWrittenBlocks()
+{
+    return upload.record.blocks;
+}
+
+// CRC16 of the uploaded animation in the EEPROM
+static uint16_t eepromCrc()
+{
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+
+    crc = _crc16_update(crc, upload.record.firstByte);
+    for (i = 1; i < upload.record.size; ++i) {
+        crc = _crc16_update(crc, eeprom_read_byte((const uint8_t *)(uintptr_t)i));
+    }
+    return crc;
+}
+
+// Follow the EEPROM writes
+uint8_t uploadPoll()
+{
+    if (upload.state == STATE_STARTING && !eepromWriting()) {
+        upload.state = STATE_RECEIVING;
+    }
+    if (upload.state == STATE_WRITING && !eepromWriting()) {
+        // the block is only acknowledged once the record covers it, the first block also
+        // saves the first byte
+        ++upload.record.blocks;
+        upload.state = STATE_RECORDING;
+        if (upload.record.blocks == 1) {
+            eepromWrite(UPLOAD_RECORD_ADDRESS, &upload.record.firstByte, 2);
+        } else {
+            eepromWrite(UPLOAD_RECORD_ADDRESS + 1, &upload.record.blocks, 1);
+        }
+    }
+    if (upload.state == STATE_RECORDING && !eepromWriting()) {
+        upload.state = STATE_RECEIVING;
+        return UPLOAD_ACK;
+    }
+    if (upload.state == STATE_RECEIVING &&
+        (uint16_t)upload.record.blocks * UPLOAD_BLOCK_SIZE >= upload.record.size) {
+        if (eepromCrc() != upload.record.crc) {
+            upload.state = STATE_NONE;
+            return UPLOAD_FAILED;
+        }
+        uploadBuffer[0] = upload.record.firstByte;
+        upload.state = STATE_COMMITTING;
+        eepromWrite(0, uploadBuffer, 1);
+    }
+    if (upload.state == STATE_COMMITTING && !eepromWriting()) {
+        upload.state = STATE_NONE;
+        return UPLOAD_DONE;
+    }
+    return UPLOAD_IDLE;
+}
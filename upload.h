@@ -0,0 +1,83 @@
+/*
+ * Project: LEDcube
+ * Author:  Sandro Lutz
+ * Email:   sandro.lutz@temparus.ch
+ */
+
+#ifndef LEDCUBE_UPLOAD_H
+#define LEDCUBE_UPLOAD_H
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------------------
+// Animation upload into the EEPROM
+// ---------------------------------------------------------------------------------------
+// Text commands in STATE SERIAL, the arguments are binary (LSB first):
+//
+//   "UPLOAD" [size, 2 bytes] [CRC16 of the animation, 2 bytes] "\r\n"
+//        -> "UPLOAD <block>": send the blocks from this one on. An unfinished upload
+//           with the same size and CRC is resumed, everything else starts over.
+//           "UPLOAD ERROR" if it doesn't fit or a block is still being written.
+//   "BLOCK" [index, 2 bytes] [UPLOAD_BLOCK_SIZE bytes] [CRC8 of index and data] "\r\n"
+//        -> "ACK <index>" once the block is in the EEPROM,
+//           "NAK <block>" if it was dropped (CRC, not the expected block or busy)
+//   after the last block: "DONE", or "FAILED" if the CRC16 of the EEPROM is wrong
+//
+// The last block is padded to UPLOAD_BLOCK_SIZE. The CRC8 is _crc_ibutton_update, the
+// CRC16 is _crc16_update starting with 0xFFFF.
+// The EEPROM is written by its ready interrupt, one byte at a time, so neither the
+// display nor the serial port has to wait for it. The first byte of the animation is
+// written last: the cube never plays a half uploaded animation (See animation.h).
+// Size, CRC16, first byte and the number of written blocks are kept in a record at the
+// end of the EEPROM and updated after every block (one more byte write per block), so an
+// upload survives a reset of the cube (e.g. the auto-reset when the port is opened): the
+// next UPLOAD with the same size and CRC continues where it stopped.
+
+#define UPLOAD_BLOCK_SIZE 16
+
+// Resume record at the end of the EEPROM, the animation has the space in front of it
+#define UPLOAD_RECORD_SIZE 6
+#define UPLOAD_RECORD_ADDRESS (E2END + 1 - UPLOAD_RECORD_SIZE)
+#define UPLOAD_SPACE UPLOAD_RECORD_ADDRESS
+
+#define UPLOAD_ARGUMENTS_SIZE 4
+#define BLOCK_ARGUMENTS_SIZE (2 + UPLOAD_BLOCK_SIZE + 1)
+
+// Receives the arguments of the UPLOAD and BLOCK commands
+extern uint8_t uploadBuffer[BLOCK_ARGUMENTS_SIZE];
+
+// Results of uploadStart()
+#define UPLOAD_INVALID 0xFFFF   // the animation doesn't fit into the EEPROM
+#define UPLOAD_BUSY    0xFFFE   // the EEPROM is still being written, try again
+
+// Results of uploadBlock()
+#define BLOCK_WRITING 0         // the block is being written, uploadPoll() reports it
+#define BLOCK_ACK     1         // the block has been written before
+#define BLOCK_NAK     2         // the block has been dropped
+
+// Results of uploadPoll()
+#define UPLOAD_IDLE   0
+#define UPLOAD_ACK    1         // a block has been written (See uploadWrittenBlocks())
+#define UPLOAD_DONE   2         // the animation is complete
+#define UPLOAD_FAILED 3         // the CRC16 doesn't match, the upload has been dropped
+
+// Load the record of an upload interrupted by a reset, call it from setup()
+void uploadInit();
+
+// Start or resume an upload (arguments in uploadBuffer)
+// Returns the block the host continues with, UPLOAD_INVALID or UPLOAD_BUSY.
+uint16_t uploadStart();
+
+// Handle a block (arguments in uploadBuffer)
+uint8_t uploadBlock();
+
+// Whether uploadBuffer is in use: a BLOCK received now has to be dropped
+bool uploadBusy();
+
+// Number of blocks in the EEPROM, the next block expected
+uint16_t uploadWrittenBlocks();
+
+// Follow the EEPROM writes, call it from the main loop
+uint8_t uploadPoll();
+
+#endif
@@ -4,7 +4,7 @@
  * Email:   sandro.lutz@temparus.ch
  */
 
-#include "Utils.h"
+#include "utils.h"
 
 unsigned long getTimeDifference(unsigned long time1, unsigned long time2)
 {